@@ -144,6 +144,14 @@ public:
                            "This is a Cap'n Proto compiler plugin which generates JavaScript code. "
                            "It is meant to be run using the Cap'n Proto compiler, e.g.:\n"
                            "    capnp compile -ojs foo.capnp")
+    .addOption({"prototypes"}, KJ_BIND_METHOD(*this, enablePrototypes),
+               "Generate Reader and Builder classes with their methods on the prototype "
+               "instead of closures created per instance.  The compiler doesn't pass "
+               "arguments to plugins, so use e.g.:\n"
+               "    capnp compile -o- foo.capnp | capnpc-js --prototypes")
+    .addOption({"bigint"}, KJ_BIND_METHOD(*this, enableBigInts),
+               "Represent Int64 and UInt64 values, defaults and constants as BigInt "
+               "instead of [hi, lo] arrays of two 32-bit numbers.")
     .callAfterParsing(KJ_BIND_METHOD(*this, run))
     .build();
   }
@@ -152,6 +160,25 @@ private:
   kj::ProcessContext& context;
   SchemaLoader schemaLoader;
   std::unordered_set<uint64_t> usedImports;
+  bool prototypes = false;
+  bool bigints = false;
+
+  kj::MainBuilder::Validity enablePrototypes() {
+    prototypes = true;
+    return true;
+  }
+
+  kj::MainBuilder::Validity enableBigInts() {
+    bigints = true;
+    return true;
+  }
+
+  // Where generated Reader/Builder methods are declared, and how they refer to the wrapped
+  // StructReader/StructBuilder, depending on whether --prototypes was given.
+  kj::StringPtr readerDecl() { return prototypes ? "Reader.prototype." : "this."; }
+  kj::StringPtr builderDecl() { return prototypes ? "Builder.prototype." : "this."; }
+  kj::StringPtr readerRef() { return prototypes ? "this._reader" : "_reader"; }
+  kj::StringPtr builderRef() { return prototypes ? "this._builder" : "_builder"; }
 
   kj::StringTree cppFullName(schema::CodeGeneratorRequest::RequestedFile::Reader request, Schema schema) {
     auto node = schema.getProto();
@@ -212,11 +239,11 @@ private:
       case schema::Type::INT8: return kj::strTree("int8");
       case schema::Type::INT16: return kj::strTree("int16");
       case schema::Type::INT32: return kj::strTree("int32");
-      case schema::Type::INT64: return kj::strTree("int64");
+      case schema::Type::INT64: return kj::strTree(bigints ? "bigint64" : "int64");
       case schema::Type::UINT8: return kj::strTree("uint8");
       case schema::Type::UINT16: return kj::strTree("uint16");
       case schema::Type::UINT32: return kj::strTree("uint32");
-      case schema::Type::UINT64: return kj::strTree("uint64");
+      case schema::Type::UINT64: return kj::strTree(bigints ? "biguint64" : "uint64");
       case schema::Type::FLOAT32: return kj::strTree("float32");
       case schema::Type::FLOAT64: return kj::strTree("float64");
       case schema::Type::ENUM: return kj::strTree("uint16");
@@ -236,11 +263,11 @@ private:
       case schema::Type::INT8: return kj::strTree("capnp.prim.int8_t");
       case schema::Type::INT16: return kj::strTree("capnp.prim.int16_t");
       case schema::Type::INT32: return kj::strTree("capnp.prim.int32_t");
-      case schema::Type::INT64: return kj::strTree("capnp.prim.int64_t");
+      case schema::Type::INT64: return kj::strTree(bigints ? "capnp.prim.bigint64_t" : "capnp.prim.int64_t");
       case schema::Type::UINT8: return kj::strTree("capnp.prim.uint8_t");
       case schema::Type::UINT16: return kj::strTree("capnp.prim.uint16_t");
       case schema::Type::UINT32: return kj::strTree("capnp.prim.uint32_t");
-      case schema::Type::UINT64: return kj::strTree("capnp.prim.uint64_t");
+      case schema::Type::UINT64: return kj::strTree(bigints ? "capnp.prim.biguint64_t" : "capnp.prim.uint64_t");
       case schema::Type::FLOAT32: return kj::strTree("capnp.prim.float32_t");
       case schema::Type::FLOAT64: return kj::strTree("capnp.prim.float64_t");
 
@@ -290,8 +317,10 @@ private:
       case schema::Value::UINT16: return kj::strTree(value.getUint16());
       case schema::Value::UINT32: return kj::strTree(value.getUint32());
       case schema::Value::INT64:
+        if (bigints) return kj::strTree(value.getInt64(), "n");
         return kj::strTree("[", value.getInt64() >> 32, ", ", value.getInt64() & 0xffffffff, "]");
       case schema::Value::UINT64:
+        if (bigints) return kj::strTree(value.getUint64(), "n");
         return kj::strTree("[", value.getUint64() >> 32, ", ", value.getUint64() & 0xffffffff, "]");
       case schema::Value::FLOAT32: return kj::strTree(value.getFloat32());
       case schema::Value::FLOAT64: return kj::strTree(value.getFloat64());
@@ -518,9 +547,9 @@ private:
           "  if (this.which() != ", discrimValue, ") return false;\n"),
       kj::str(
           "  if (this.which() != ", discrimValue, ") throw new Error(\"Must check which() before get()ing a union member.\");\n"),
-      kj::str("_builder.setDataField_uint16(", discrimOffset, ", ", discrimValue, ");\n"),
-      kj::strTree(indent(outerIndent), "this.is", titleCase, " = function() { return this.which() === ", scope, upperCase, "; };\n"),
-      kj::strTree(indent(outerIndent), "this.is", titleCase, " = function() { return this.which() === ", scope, upperCase, "; };\n")
+      kj::str(builderRef(), ".setDataField_uint16(", discrimOffset, ", ", discrimValue, ");\n"),
+      kj::strTree(indent(outerIndent), readerDecl(), "is", titleCase, " = function() { return this.which() === ", scope, upperCase, "; };\n"),
+      kj::strTree(indent(outerIndent), builderDecl(), "is", titleCase, " = function() { return this.which() === ", scope, upperCase, "; };\n")
       };
   }
 
@@ -529,8 +558,104 @@ private:
   struct FieldText {
     kj::StringTree readerMethodDecls;
     kj::StringTree builderMethodDecls;
+
+    // For the struct's toObject()/fromObject(): an expression reading the field from the
+    // StructReader `r`, and a statement writing `v` to the StructBuilder `b`.  Fields that can't
+    // be converted leave both empty.
+    kj::String toObjectValue;
+    kj::String fromObjectStmt;
+  };
+
+  struct DataFieldConversion {
+    kj::String toObjectValue;
+    kj::String fromObjectStmt;
   };
 
+  DataFieldConversion makeDataFieldConversion(schema::Type::Which whichType, uint offset,
+                                              kj::StringPtr suffix, kj::StringPtr defaultMask) {
+    // Most data fields are read and written straight through the segment's DataView at a constant
+    // byte offset from the struct's data section.  Fields past the end of a (smaller, older)
+    // struct read as their default, like the StructReader getters do.
+    const char* getter = nullptr;
+    const char* setter = nullptr;
+    bool littleEndian = true;
+    bool bigint = false;
+    switch (whichType) {
+      case schema::Type::INT8: getter = "getInt8"; setter = "setInt8"; littleEndian = false; break;
+      case schema::Type::UINT8: getter = "getUint8"; setter = "setUint8"; littleEndian = false; break;
+      case schema::Type::INT16: getter = "getInt16"; setter = "setInt16"; break;
+      case schema::Type::UINT16: getter = "getUint16"; setter = "setUint16"; break;
+      case schema::Type::ENUM: getter = "getUint16"; setter = "setUint16"; break;
+      case schema::Type::INT32: getter = "getInt32"; setter = "setInt32"; break;
+      case schema::Type::UINT32: getter = "getUint32"; setter = "setUint32"; break;
+      case schema::Type::FLOAT32:
+        if (defaultMask.size() == 0) { getter = "getFloat32"; setter = "setFloat32"; }
+        break;
+      case schema::Type::FLOAT64:
+        if (defaultMask.size() == 0) { getter = "getFloat64"; setter = "setFloat64"; }
+        break;
+      case schema::Type::INT64:
+        if (bigints) { getter = "getBigInt64"; setter = "setBigInt64"; bigint = true; }
+        break;
+      case schema::Type::UINT64:
+        if (bigints) { getter = "getBigUint64"; setter = "setBigUint64"; bigint = true; }
+        break;
+      default:
+        break;
+    }
+
+    kj::String maskSuffix;
+    kj::String maskParam;
+    if (defaultMask.size() > 0) {
+      maskSuffix = kj::str("_masked");
+      maskParam = kj::str(", ", defaultMask);
+    }
+
+    if (getter == nullptr) {
+      // Bools (which may sit at a bit offset within a list element), int64 pairs and masked
+      // floats go through the StructReader/StructBuilder.
+      return DataFieldConversion {
+        kj::str("r.getDataField_", suffix, maskSuffix, "(", offset, maskParam, ")"),
+        kj::str("b.setDataField_", suffix, maskSuffix, "(", offset, ", v", maskParam, ");")
+      };
+    }
+
+    uint bits = typeSizeBits(whichType);
+    uint byteOffset = offset * bits / 8;
+    kj::StringPtr endian = littleEndian ? ", true" : "";
+    auto read = kj::str("(bits > ", offset * bits, " ? dv.", getter, "(d + ", byteOffset, endian, ") : ",
+                        bigint ? "0n" : "0", ")");
+    // Plain objects may hold 64-bit values as numbers, which DataView.setBigInt64 rejects.
+    kj::StringPtr value = bigint ? "BigInt(v)" : "v";
+
+    if (defaultMask.size() == 0) {
+      return DataFieldConversion {
+        kj::mv(read),
+        kj::str("dv.", setter, "(d + ", byteOffset, ", ", value, endian, ");")
+      };
+    }
+
+    return DataFieldConversion {
+      whichType == schema::Type::UINT32
+      ? kj::str("((", read, " ^ ", defaultMask, ") >>> 0)")
+      : kj::str("(", read, " ^ ", defaultMask, ")"),
+      kj::str("dv.", setter, "(d + ", byteOffset, ", ", value, " ^ ", defaultMask, endian, ");")
+    };
+  }
+
+  bool hasObjectConversion(schema::Type::Reader type) {
+    // Interfaces and untyped objects have no plain object representation.
+    switch (type.which()) {
+      case schema::Type::INTERFACE:
+      case schema::Type::OBJECT:
+        return false;
+      case schema::Type::LIST:
+        return hasObjectConversion(type.getList().getElementType());
+      default:
+        return true;
+    }
+  }
+
   enum class FieldKind {
     PRIMITIVE,
       BLOB,
@@ -561,7 +686,7 @@ private:
         return FieldText {
           kj::strTree(
               kj::mv(unionDiscrim.readerIsDecl),
-              indent(outerIndent), "this.has", titleCase, " = function() {\n",
+              indent(outerIndent), readerDecl(), "has", titleCase, " = function() {\n",
               indent(outerIndent + 2), "return ",
 
               kj::StringTree(KJ_MAP(slot, slots) {
@@ -570,21 +695,21 @@ private:
                     case Section::NONE:
                       return kj::strTree();
                     case Section::DATA:
-                      return kj::strTree("_reader.hasDataField_", suffix, "(", slot.offset, ")");
+                      return kj::strTree(readerRef(), ".hasDataField_", suffix, "(", slot.offset, ")");
                     case Section::POINTERS:
                       return kj::strTree(
-                          "!_reader.isPointerFieldNull(", slot.offset, ")");
+                          "!", readerRef(), ".isPointerFieldNull(", slot.offset, ")");
                   }
                   KJ_UNREACHABLE;
                 }, kj::strTree("\n", indent(outerIndent + 2), "       || ").flatten()),
               ";\n",
               indent(outerIndent), "};\n",
-              indent(outerIndent), "this.get", titleCase, " = function() { return new module.", fullName, ".Reader(_reader); };\n",
+              indent(outerIndent), readerDecl(), "get", titleCase, " = function() { return new module.", fullName, ".Reader(", readerRef(), "); };\n",
               "\n"),
 
           kj::strTree(
               kj::mv(unionDiscrim.builderIsDecl),
-              indent(outerIndent), "this.has", titleCase, " = function() {\n",
+              indent(outerIndent), builderDecl(), "has", titleCase, " = function() {\n",
               indent(outerIndent + 2), "return ",
 
               kj::StringTree(KJ_MAP(slot, slots) {
@@ -593,17 +718,17 @@ private:
                     case Section::NONE:
                       return kj::strTree();
                     case Section::DATA:
-                      return kj::strTree("_builder.hasDataField_", suffix, "(", slot.offset, ")");
+                      return kj::strTree(builderRef(), ".hasDataField_", suffix, "(", slot.offset, ")");
                     case Section::POINTERS:
                       return kj::strTree(
-                          "!_builder.isPointerFieldNull(", slot.offset, ")");
+                          "!", builderRef(), ".isPointerFieldNull(", slot.offset, ")");
                   }
                   KJ_UNREACHABLE;
                 }, kj::strTree("\n", indent(outerIndent + 2), "       || ").flatten()),
               ";\n",
               indent(outerIndent), "};\n",
-              indent(outerIndent), "this.get", titleCase, " = function() { return new module.", fullName, ".Builder(_builder); };\n",
-              indent(outerIndent), "this.init", titleCase, " = function() {\n",
+              indent(outerIndent), builderDecl(), "get", titleCase, " = function() { return new module.", fullName, ".Builder(", builderRef(), "); };\n",
+              indent(outerIndent), builderDecl(), "init", titleCase, " = function() {\n",
 
               indent(outerIndent + 2), unionDiscrim.set, "\n",
               indent(outerIndent + 2),
@@ -613,17 +738,20 @@ private:
                     case Section::NONE:
                       return kj::strTree();
                     case Section::DATA:
-                      return kj::strTree("_builder.setDataField_", suffix, "(", slot.offset, ", 0)");
+                      return kj::strTree(builderRef(), ".setDataField_", suffix, "(", slot.offset, ", 0)");
                     case Section::POINTERS:
                       return kj::strTree(
-                          "_builder.clearPointerField(", slot.offset, ");");
+                          builderRef(), ".clearPointerField(", slot.offset, ");");
                   }
                   KJ_UNREACHABLE;
                 }, kj::strTree("\n", indent(outerIndent + 2), "").flatten()),
               "\n",
-              indent(outerIndent + 2), "return new module.", fullName, ".Builder(_builder);\n",
+              indent(outerIndent + 2), "return new module.", fullName, ".Builder(", builderRef(), ");\n",
               indent(outerIndent), "};\n",
               "\n"),
+
+          kj::str("module.", fullName, ".toObject(r)"),
+          kj::str("module.", fullName, ".fromObject(b, v);")
           };
       }
     }
@@ -665,16 +793,24 @@ private:
       case schema::Type::INT64:
         kind = FieldKind::PRIMITIVE;
         if (defaultBody.getInt64() != 0) {
-          int32_t hi = (defaultBody.getInt64() >> 32);
-          int32_t lo = static_cast<int32_t>(defaultBody.getUint64() & 0xffffffff);
-          defaultMask = kj::strTree("[", hi, ", ", lo, "]").flatten();
+          if (bigints) {
+            defaultMask = kj::str(defaultBody.getInt64(), "n");
+          } else {
+            int32_t hi = (defaultBody.getInt64() >> 32);
+            int32_t lo = static_cast<int32_t>(defaultBody.getUint64() & 0xffffffff);
+            defaultMask = kj::strTree("[", hi, ", ", lo, "]").flatten();
+          }
         }
         break;
 
       case schema::Type::UINT64:
         kind = FieldKind::PRIMITIVE;
         if (defaultBody.getUint64() != 0) {
-          defaultMask = kj::strTree("[", (defaultBody.getUint64() >> 32), ", ", (defaultBody.getUint64() & 0xffffffff), "]").flatten();
+          if (bigints) {
+            defaultMask = kj::str(defaultBody.getUint64(), "n");
+          } else {
+            defaultMask = kj::strTree("[", (defaultBody.getUint64() >> 32), ", ", (defaultBody.getUint64() & 0xffffffff), "]").flatten();
+          }
         }
         break;
 
@@ -762,15 +898,18 @@ private:
       kj::String getter;
       kj::String builderGetter;
       kj::String setter;
+      DataFieldConversion conversion;
 
       switch (slot.getType().which()) {
 
         case schema::Type::VOID:
-          hasGetter = kj::strTree("this.has", titleCase, " = function() { ", unionDiscrim.has, "return false; };\n").flatten();
-          builderHasGetter = kj::strTree("this.has", titleCase, " = function() { ", unionDiscrim.has, "return false; };\n").flatten();
-          getter = kj::strTree("this.get", titleCase, " = function() { ", unionDiscrim.check, "return undefined; };\n").flatten();
-          builderGetter = kj::strTree("this.get", titleCase, " = function() { ", unionDiscrim.check, "return undefined; };\n").flatten();
-          setter = kj::strTree("this.set", titleCase, " = function(val) { ", unionDiscrim.set, " };\n").flatten();
+          hasGetter = kj::strTree(readerDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return false; };\n").flatten();
+          builderHasGetter = kj::strTree(builderDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return false; };\n").flatten();
+          getter = kj::strTree(readerDecl(), "get", titleCase, " = function() { ", unionDiscrim.check, "return undefined; };\n").flatten();
+          builderGetter = kj::strTree(builderDecl(), "get", titleCase, " = function() { ", unionDiscrim.check, "return undefined; };\n").flatten();
+          setter = kj::strTree(builderDecl(), "set", titleCase, " = function(val) { ", unionDiscrim.set, " };\n").flatten();
+          // Only union members are converted; there's nothing to store.
+          conversion.toObjectValue = kj::str("null");
           break;
 
         case schema::Type::ENUM:
@@ -785,20 +924,20 @@ private:
         case schema::Type::INT64:
         case schema::Type::UINT64:
         case schema::Type::BOOL:
-          hasGetter = kj::strTree("this.has", titleCase, " = function() { ", unionDiscrim.has, "return _reader.hasDataField_", suffix, defaultMaskSuffix, "(", offset, "); };\n").flatten();
-          builderHasGetter = kj::strTree("this.has", titleCase, " = function() { ", unionDiscrim.has, "return _builder.hasDataField_", suffix, defaultMaskSuffix, "(", offset, "); };\n").flatten();
-          getter = kj::strTree("this.get", titleCase, " = function() { ", unionDiscrim.check, "return _reader.getDataField_", suffix, defaultMaskSuffix, "(", offset, defaultMaskParam, "); };\n").flatten();
-          builderGetter = kj::strTree("this.get", titleCase, " = function() { ", unionDiscrim.check, "return _builder.getDataField_", suffix, defaultMaskSuffix, "(", offset, defaultMaskParam, "); };\n").flatten();
-          setter = kj::strTree("this.set", titleCase, " = function(value) { ", unionDiscrim.set, "_builder.setDataField_", suffix, defaultMaskSuffix, "(", offset, defaultMaskParam, ", value); };\n").flatten();
-
+          hasGetter = kj::strTree(readerDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return ", readerRef(), ".hasDataField_", suffix, defaultMaskSuffix, "(", offset, "); };\n").flatten();
+          builderHasGetter = kj::strTree(builderDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return ", builderRef(), ".hasDataField_", suffix, defaultMaskSuffix, "(", offset, "); };\n").flatten();
+          getter = kj::strTree(readerDecl(), "get", titleCase, " = function() { ", unionDiscrim.check, "return ", readerRef(), ".getDataField_", suffix, defaultMaskSuffix, "(", offset, defaultMaskParam, "); };\n").flatten();
+          builderGetter = kj::strTree(builderDecl(), "get", titleCase, " = function() { ", unionDiscrim.check, "return ", builderRef(), ".getDataField_", suffix, defaultMaskSuffix, "(", offset, defaultMaskParam, "); };\n").flatten();
+          setter = kj::strTree(builderDecl(), "set", titleCase, " = function(value) { ", unionDiscrim.set, builderRef(), ".setDataField_", suffix, defaultMaskSuffix, "(", offset, ", value", defaultMaskParam, "); };\n").flatten();
+          conversion = makeDataFieldConversion(slot.getType().which(), offset, suffix, defaultMask);
           break;
 
         default:
-          hasGetter = kj::strTree("this.has", titleCase, " = function() { ", unionDiscrim.has, "return seg.getUint32(", offset, ") !== 0 && seg.getUint32(", offset + 4, ") !== 0; };\n").flatten();
-          builderHasGetter = kj::strTree("this.has", titleCase, " = function() { ", unionDiscrim.has, "return seg.getUint32(", offset, ") !== 0 && seg.getUint32(", offset + 4, ") !== 0; };\n").flatten();
-          getter = kj::strTree("this.get", titleCase, " = function() { ", unionDiscrim.check, "return ", type, ".Reader(msg, seg, ofs + ", (offset * 8), defaultMaskParam, "); };\n").flatten();
-          setter = kj::strTree("this.set", titleCase, " = function(value) { ", unionDiscrim.set, type, ".Builder(msg, seg, ofs + ", (offset * 8), defaultMaskParam, ").set(value); };\n").flatten();
-          builderGetter = kj::strTree("this.get", titleCase, " = function() { return new ", type, ".Builder(_builder); };\n").flatten();
+          hasGetter = kj::strTree(readerDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return seg.getUint32(", offset, ") !== 0 && seg.getUint32(", offset + 4, ") !== 0; };\n").flatten();
+          builderHasGetter = kj::strTree(builderDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return seg.getUint32(", offset, ") !== 0 && seg.getUint32(", offset + 4, ") !== 0; };\n").flatten();
+          getter = kj::strTree(readerDecl(), "get", titleCase, " = function() { ", unionDiscrim.check, "return ", type, ".Reader(msg, seg, ofs + ", (offset * 8), defaultMaskParam, "); };\n").flatten();
+          setter = kj::strTree(builderDecl(), "set", titleCase, " = function(value) { ", unionDiscrim.set, type, ".Builder(msg, seg, ofs + ", (offset * 8), defaultMaskParam, ").set(value); };\n").flatten();
+          builderGetter = kj::strTree(builderDecl(), "get", titleCase, " = function() { return new ", type, ".Builder(", builderRef(), "); };\n").flatten();
       }
 
 
@@ -815,6 +954,9 @@ private:
             indent(outerIndent), builderGetter,
             indent(outerIndent), setter,
             "\n"),
+
+        kj::mv(conversion.toObjectValue),
+        kj::mv(conversion.fromObjectStmt)
         };
 
     } else if (kind == FieldKind::INTERFACE) {
@@ -825,18 +967,18 @@ private:
       return FieldText {
         kj::strTree(
             kj::mv(unionDiscrim.readerIsDecl),
-            indent(outerIndent), "this.has", titleCase, " = function() { ", unionDiscrim.has, "return !_reader.isPointerFieldNull(", offset, "); };\n",
-            indent(outerIndent), "this.get", titleCase, " = function(type) { return capnp.genhelper.objectGetFromReader(type, _reader, ", offset, "); },\n",
+            indent(outerIndent), readerDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return !", readerRef(), ".isPointerFieldNull(", offset, "); };\n",
+            indent(outerIndent), readerDecl(), "get", titleCase, " = function(type) { return capnp.genhelper.objectGetFromReader(type, ", readerRef(), ", ", offset, "); },\n",
             "\n"),
 
         kj::strTree(
             kj::mv(unionDiscrim.builderIsDecl),
-            indent(outerIndent), "this.has", titleCase, " = function() { ", unionDiscrim.has, "return !_builder.isPointerFieldNull(", offset, "); };\n",
-            indent(outerIndent), "this.get", titleCase, " = function(type) { return capnp.genhelper.objectGetFromBuilder(type, _builder, ", offset, "); };\n",
-            indent(outerIndent), "this.set", titleCase, " = function(type, value) { capnp.genhelper.objectSet(type, _builder, ", offset, ", value); };\n",
-            indent(outerIndent), "this.init", titleCase, " = function(type, arg /* , arg... */) { return capnp.genhelper.objectInit(_builder, ", offset, ", arguments); };\n",
-            indent(outerIndent), "this.adopt", titleCase, " = function(type, value) { return capnp.genhelper.objectAdopt(type, _builder, ", offset, ", value); };\n",
-            indent(outerIndent), "this.disown", titleCase, " = function(type) { return capnp.genhelper.objectDisown(type, _builder, ", offset, "); };\n",
+            indent(outerIndent), builderDecl(), "has", titleCase, " = function() { ", unionDiscrim.has, "return !", builderRef(), ".isPointerFieldNull(", offset, "); };\n",
+            indent(outerIndent), builderDecl(), "get", titleCase, " = function(type) { return capnp.genhelper.objectGetFromBuilder(type, ", builderRef(), ", ", offset, "); };\n",
+            indent(outerIndent), builderDecl(), "set", titleCase, " = function(type, value) { capnp.genhelper.objectSet(type, ", builderRef(), ", ", offset, ", value); };\n",
+            indent(outerIndent), builderDecl(), "init", titleCase, " = function(type, arg /* , arg... */) { return capnp.genhelper.objectInit(", builderRef(), ", ", offset, ", arguments); };\n",
+            indent(outerIndent), builderDecl(), "adopt", titleCase, " = function(type, value) { return capnp.genhelper.objectAdopt(type, ", builderRef(), ", ", offset, ", value); };\n",
+            indent(outerIndent), builderDecl(), "disown", titleCase, " = function(type) { return capnp.genhelper.objectDisown(type, ", builderRef(), ", ", offset, "); };\n",
             "\n")
         };
 
@@ -886,62 +1028,140 @@ private:
             primitiveElement ? "" : "::Reader");
       }
 
+      // Null pointers without a default become null rather than an empty value.
+      kj::String nullCheck = defaultOffset == 0
+          ? kj::str("r.isPointerFieldNull(", offset, ") ? null : ") : kj::str();
+      kj::String toObjectValue;
+      kj::String fromObjectStmt;
+      if (kind == FieldKind::BLOB && slot.getType().which() == schema::Type::TEXT) {
+        toObjectValue = kj::str(nullCheck, "capnp.blob.Text.getReader(r, ", offset, defaultParam, ").str()");
+        fromObjectStmt = kj::str("b.setTextBlobField(", offset, ", v);");
+      } else if (kind == FieldKind::BLOB) {
+        toObjectValue = kj::str(nullCheck, "capnp.blob.copyDataBytes(capnp.blob.Data.getReader(r, ", offset, defaultParam, "))");
+        fromObjectStmt = kj::str("b.setDataBlobField(", offset, ", v);");
+      } else if (kind == FieldKind::STRUCT) {
+        toObjectValue = kj::str(nullCheck, type, ".toObject(r.getStructField(", offset, defaultParam, "))");
+        fromObjectStmt = kj::str(type, ".fromObject(b.initStructField(", offset, ", ", type, ".STRUCT_SIZE), v);");
+      } else if (hasObjectConversion(typeBody)) {
+        toObjectValue = kj::str(nullCheck, type, ".toArray(", type, ".getReaderAsFieldOf(r, ", offset, defaultParam, "))");
+        fromObjectStmt = kj::str(type, ".fromArray(", type, ".initBuilderAsFieldOf(b, ", offset, ", v.length), v);");
+      }
+
       return FieldText {
         kj::strTree(
             kj::mv(unionDiscrim.readerIsDecl),
-            indent(outerIndent), "this.has", titleCase, " = function() { return !_reader.isPointerFieldNull(", offset, "); };\n",
+            indent(outerIndent), readerDecl(), "has", titleCase, " = function() { return !", readerRef(), ".isPointerFieldNull(", offset, "); };\n",
             kind == FieldKind::STRUCT ?
-            kj::strTree(indent(outerIndent), "this.get", titleCase, " = function() { return new ", type, ".Reader(_reader.getStructField(", offset, defaultParam, ")); };\n")
+            kj::strTree(indent(outerIndent), readerDecl(), "get", titleCase, " = function() { return new ", type, ".Reader(", readerRef(), ".getStructField(", offset, defaultParam, ")); };\n")
             :
-            kj::strTree(indent(outerIndent), "this.get", titleCase, " = function() { return ", type, ".getReader(_reader, ", offset, defaultParam, "); };\n"),
+            kj::strTree(indent(outerIndent), readerDecl(), "get", titleCase, " = function() { return ", type, ".getReader(", readerRef(), ", ", offset, defaultParam, "); };\n"),
             "\n"),
 
         kj::strTree(
             kj::mv(unionDiscrim.builderIsDecl),
-            indent(outerIndent), "this.has", titleCase, " = function() { return !_builder.isPointerFieldNull(", offset, "); };\n",
+            indent(outerIndent), builderDecl(), "has", titleCase, " = function() { return !", builderRef(), ".isPointerFieldNull(", offset, "); };\n",
             kind == FieldKind::STRUCT
-            ? kj::strTree(indent(outerIndent), "this.get", titleCase, " = function() { return new ", type, ".Builder(_builder.getStructField(", offset, ", module.", scope, "STRUCT_SIZE", defaultParam, ")); };\n")
-            : kj::strTree(indent(outerIndent), "this.get", titleCase, " = function() { return ", type, ".getBuilder(_builder, ", offset, defaultParam, "); };\n"),
+            ? kj::strTree(indent(outerIndent), builderDecl(), "get", titleCase, " = function() { return new ", type, ".Builder(", builderRef(), ".getStructField(", offset, ", module.", scope, "STRUCT_SIZE", defaultParam, ")); };\n")
+            : kj::strTree(indent(outerIndent), builderDecl(), "get", titleCase, " = function() { return ", type, ".getBuilder(", builderRef(), ", ", offset, defaultParam, "); };\n"),
 
-            indent(outerIndent), "this.set", titleCase, " = function(val) { ", unionDiscrim.set,
+            indent(outerIndent), builderDecl(), "set", titleCase, " = function(val) { ", unionDiscrim.set,
 
             kind == FieldKind::BLOB
-            ? ((slot.getType().which() == schema::Type::TEXT) ? kj::strTree("capnp.genhelper.textBlobSet(_builder, ", offset, ", val); };\n") : kj::strTree("capnp.genhelper.dataBlobSet(_builder, ", offset, ", val); };\n"))
+            ? ((slot.getType().which() == schema::Type::TEXT) ? kj::strTree("capnp.genhelper.textBlobSet(", builderRef(), ", ", offset, ", val); };\n") : kj::strTree("capnp.genhelper.dataBlobSet(", builderRef(), ", ", offset, ", val); };\n"))
             : (kind == FieldKind::LIST
-               ? kj::strTree("capnp.genhelper.listSet(", type, ", _builder, ", offset, ", val); };\n")
-               : kj::strTree("capnp.genhelper.structSet(", type, ", _builder, ", offset, ", val); };\n")),
+               ? kj::strTree("capnp.genhelper.listSet(", type, ", ", builderRef(), ", ", offset, ", val); };\n")
+               : kj::strTree("capnp.genhelper.structSet(", type, ", ", builderRef(), ", ", offset, ", val); };\n")),
 
             kind == FieldKind::LIST && !isStructList
             ? kj::strTree()
             : kj::strTree(),
 
             kind == FieldKind::STRUCT
-            ? kj::strTree(indent(outerIndent), "this.init", titleCase, " = function(size) {\n",
-                          indent(outerIndent + 2), "return new ", type, ".Builder(_builder.initStructField(", offset, ", ", type, ".STRUCT_SIZE));\n",
+            ? kj::strTree(indent(outerIndent), builderDecl(), "init", titleCase, " = function(size) {\n",
+                          indent(outerIndent + 2), "return new ", type, ".Builder(", builderRef(), ".initStructField(", offset, ", ", type, ".STRUCT_SIZE));\n",
                           indent(outerIndent), "};\n")
-            : isStructList ? kj::strTree(indent(outerIndent), "this.init", titleCase, " = function(size) { return ", type, ".initBuilder(_builder, ", offset,  ", size); };\n") :
+            : isStructList ? kj::strTree(indent(outerIndent), builderDecl(), "init", titleCase, " = function(size) { return ", type, ".initBuilder(", builderRef(), ", ", offset,  ", size); };\n") :
 
-            kj::strTree(indent(outerIndent), "this.init", titleCase, " = function(size) { return new ", type, ".initBuilder(_builder, ", offset,  ", size); };\n"),
-            indent(outerIndent), "this.adopt", titleCase, " = function(val) { capnp.genhelper.structAdopt(", type, ", _builder, ", offset, ", val); };;\n",
+            kj::strTree(indent(outerIndent), builderDecl(), "init", titleCase, " = function(size) { return new ", type, ".initBuilder(", builderRef(), ", ", offset,  ", size); };\n"),
+            indent(outerIndent), builderDecl(), "adopt", titleCase, " = function(val) { capnp.genhelper.structAdopt(", type, ", ", builderRef(), ", ", offset, ", val); };;\n",
 
-            indent(outerIndent), "this.disown", titleCase, " = function() { ",
+            indent(outerIndent), builderDecl(), "disown", titleCase, " = function() { ",
             kind == FieldKind::BLOB
-            ? ((slot.getType().which() == schema::Type::TEXT) ? kj::strTree("return capnp.genhelper.textBlobDisown(_builder, ", offset, "); };\n") : kj::strTree("return capnp.genhelper.dataBlobDisown(_builder, ", offset, "); };\n"))
+            ? ((slot.getType().which() == schema::Type::TEXT) ? kj::strTree("return capnp.genhelper.textBlobDisown(", builderRef(), ", ", offset, "); };\n") : kj::strTree("return capnp.genhelper.dataBlobDisown(", builderRef(), ", ", offset, "); };\n"))
             : (kind == FieldKind::LIST
-               ? kj::strTree("return capnp.genhelper.listDisown(", type, ", _builder, ", offset, "); };\n")
-               : kj::strTree("return capnp.genhelper.structDisown(", type, ", _builder, ", offset, "); };\n")),
+               ? kj::strTree("return capnp.genhelper.listDisown(", type, ", ", builderRef(), ", ", offset, "); };\n")
+               : kj::strTree("return capnp.genhelper.structDisown(", type, ", ", builderRef(), ", ", offset, "); };\n")),
 
-            "\n")
+            "\n"),
+
+        kj::mv(toObjectValue),
+        kj::mv(fromObjectStmt)
         };
     }
   }
 
   // -----------------------------------------------------------------
 
+  kj::StringTree makeObjectConversions(StructSchema schema, kj::ArrayPtr<FieldText> fieldTexts, int outerIndent) {
+    // toObject() copies a struct into plain objects and arrays in a single pass over the message,
+    // without wrapping anything in generated Readers.  fromObject() is the reverse: it fills in a
+    // freshly initialized StructBuilder, allocating pointer fields as it reaches them.  Only the
+    // active union member is converted, and fromObject() picks the first member present.
+    uint discrimOffset = schema.getProto().getStruct().getDiscriminantOffset();
+
+    kj::Vector<kj::StringTree> members;
+    kj::Vector<kj::StringTree> cases;
+    kj::Vector<kj::StringTree> stores;
+    kj::Vector<kj::StringTree> unionStores;
+    for (auto field: schema.getFields()) {
+      auto& text = fieldTexts[field.getIndex()];
+      auto proto = field.getProto();
+      auto name = proto.getName();
+      if (text.toObjectValue.size() == 0) {
+        continue;
+      }
+      if (proto.hasDiscriminantValue()) {
+        cases.add(kj::strTree(
+            indent(outerIndent + 2), "case ", proto.getDiscriminantValue(), ": obj.", name, " = ", text.toObjectValue, "; break;\n"));
+        unionStores.add(kj::strTree(
+            "if (obj.", name, " !== undefined) {\n",
+            indent(outerIndent + 2), "b.setDataField_uint16(", discrimOffset, ", ", proto.getDiscriminantValue(), ");\n",
+            text.fromObjectStmt.size() == 0 ? kj::strTree() : kj::strTree(
+                indent(outerIndent + 2), "if ((v = obj.", name, ") != null) ", text.fromObjectStmt, "\n"),
+            indent(outerIndent + 1), "}"));
+      } else if (text.fromObjectStmt.size() > 0) {
+        members.add(kj::strTree(indent(outerIndent + 2), name, ": ", text.toObjectValue));
+        stores.add(kj::strTree(indent(outerIndent + 1), "if ((v = obj.", name, ") != null) ", text.fromObjectStmt, "\n"));
+      }
+    }
+
+    return kj::strTree(
+        indent(outerIndent), "toObject: function(r) {\n",
+        indent(outerIndent + 1), "var dv = r.seg_dataView, d = r.data, bits = r.dataSize;\n",
+        members.size() == 0
+        ? kj::strTree(indent(outerIndent + 1), "var obj = {};\n")
+        : kj::strTree(indent(outerIndent + 1), "var obj = {\n",
+                      kj::StringTree(members.releaseAsArray(), ",\n"), "\n",
+                      indent(outerIndent + 1), "};\n"),
+        cases.size() == 0 ? kj::strTree() : kj::strTree(
+            indent(outerIndent + 1), "switch (r.getDataField_uint16(", discrimOffset, ")) {\n",
+            cases.releaseAsArray(),
+            indent(outerIndent + 1), "}\n"),
+        indent(outerIndent + 1), "return obj;\n",
+        indent(outerIndent), "},\n",
+        indent(outerIndent), "fromObject: function(b, obj) {\n",
+        indent(outerIndent + 1), "var dv = b.seg_dataView, d = b.data, v;\n",
+        stores.releaseAsArray(),
+        unionStores.size() == 0 ? kj::strTree() : kj::strTree(
+            indent(outerIndent + 1), kj::StringTree(unionStores.releaseAsArray(), " else "), "\n"),
+        indent(outerIndent), "},\n");
+  }
+
   kj::StringTree makeReaderDef(Schema schema, kj::StringPtr fullName, kj::StringPtr unqualifiedParentType,
-                               bool isUnion, kj::Array<kj::StringTree>&& methodDecls, kj::Array<kj::String>& fieldNames, kj::StringPtr name, int outerIndent) {
+                               bool isUnion, kj::Array<kj::StringTree>&& methodDecls, kj::Array<kj::String>& fieldNames, kj::StringPtr name,
+                               kj::StringTree&& objectConversions, int outerIndent) {
     auto structNode = schema.asStruct().getProto().getStruct();
-    return kj::strTree(
+    auto header = kj::strTree(
         "\n",
         indent(outerIndent), "STRUCT_SIZE: new capnp.genhelper.StructSize(", structNode.getDataWordCount(), ", ", structNode.getPointerCount(), ", ", static_cast<uint>(structNode.getPreferredListEncoding()), "),\n",
         indent(outerIndent), "ELEMENT_SIZE: 7, // FieldSize::INLINE_COMPOSITE\n",
@@ -953,7 +1173,16 @@ private:
         indent(outerIndent), "getOrphan: function(builder) { return new this.Builder(builder.asStruct(this.STRUCT_SIZE)); },\n",
 
         indent(outerIndent), "copyOrphan: capnp.layout.OrphanBuilder.copyStruct,\n",
+        "\n",
+        kj::mv(objectConversions));
 
+    if (prototypes) {
+      return kj::strTree(kj::mv(header),
+                         makePrototypeClass("Reader", "_reader", schema, fullName, isUnion, kj::mv(methodDecls), fieldNames, name, outerIndent));
+    }
+
+    return kj::strTree(
+        kj::mv(header),
         indent(outerIndent), "Reader: function(_reader) {\n",
         indent(outerIndent + 1), "if (_reader === undefined) _reader = capnp.genhelper.NullStructReader;\n",
         indent(outerIndent + 1), "//return {\n"
@@ -964,6 +1193,7 @@ private:
         indent(outerIndent+2), "this._getInnerReader = function() { return _reader; };\n",
         indent(outerIndent+2), "this.totalSizeInWords = function() { return _reader.totalSize(); };\n",
         indent(outerIndent+2), "this._getReader = function() { return _reader; };\n",
+        indent(outerIndent+2), "this.toObject = function() { return module.", fullName, ".toObject(_reader); };\n",
         indent(outerIndent+2), "this.GET_MEMBER = [", kj::StringTree(KJ_MAP(n, fieldNames) { return kj::strTree("this.get", toTitleCase(n)); }, ", ").flatten(), "];\n",
         indent(outerIndent+2), "this.HAS_MEMBER = [", kj::StringTree(KJ_MAP(n, fieldNames) { return kj::strTree("this.has", toTitleCase(n)); }, ", ").flatten(), "];\n",
         indent(outerIndent+2), "this.toString = function() { return capnp.genhelper.ToStringHelper(this, \"", name, ".Reader\", module.", fullName, ".FIELD_LIST, this.HAS_MEMBER, this.GET_MEMBER",
@@ -976,6 +1206,10 @@ private:
 
   kj::StringTree makeBuilderDef(Schema schema, kj::StringPtr fullName, kj::StringPtr unqualifiedParentType,
                                 bool isUnion, kj::Array<kj::StringTree>&& methodDecls, kj::Array<kj::String>& fieldNames, kj::StringPtr name, int outerIndent) {
+    if (prototypes) {
+      return makePrototypeClass("Builder", "_builder", schema, fullName, isUnion, kj::mv(methodDecls), fieldNames, name, outerIndent);
+    }
+
     auto structNode = schema.asStruct().getProto().getStruct();
     return kj::strTree(
         indent(outerIndent), "Builder: function(_builder) {\n",
@@ -986,6 +1220,8 @@ private:
         //
         indent(outerIndent+2), "this.getReader = function() { return _builder.asReader(); };\n",
         indent(outerIndent+2), "this.totalSizeInWords = function() { return this.asReader().totalSizeInWords(); };\n",
+        indent(outerIndent+2), "this.toObject = function() { return module.", fullName, ".toObject(_builder.asReader()); };\n",
+        indent(outerIndent+2), "this.fromObject = function(obj) { module.", fullName, ".fromObject(_builder, obj); };\n",
         indent(outerIndent+2), "this.GET_MEMBER = [", kj::StringTree(KJ_MAP(n, fieldNames) { return kj::strTree("this.get", toTitleCase(n)); }, ", ").flatten(), "];\n",
         indent(outerIndent+2), "this.HAS_MEMBER = [", kj::StringTree(KJ_MAP(n, fieldNames) { return kj::strTree("this.has", toTitleCase(n)); }, ", ").flatten(), "];\n",
         indent(outerIndent+2), "this.toString = function() { return capnp.genhelper.ToStringHelper(this, \"", name,  ".Builder\", module.", fullName, ".FIELD_LIST, this.HAS_MEMBER, this.GET_MEMBER",
@@ -996,6 +1232,46 @@ private:
         "\n");
   }
 
+  kj::StringTree makePrototypeClass(kj::StringPtr className, kj::StringPtr member, Schema schema, kj::StringPtr fullName,
+                                    bool isUnion, kj::Array<kj::StringTree>&& methodDecls, kj::Array<kj::String>& fieldNames, kj::StringPtr name, int outerIndent) {
+    // Prototype mode: the wrapped StructReader/StructBuilder is kept in a member, and all
+    // methods live on the prototype, so wrapping a struct allocates exactly one small object
+    // instead of one closure per field.
+    auto structNode = schema.asStruct().getProto().getStruct();
+    bool isReader = className == "Reader";
+    auto proto = kj::str(className, ".prototype.");
+    return kj::strTree(
+        indent(outerIndent), className, ": function() {\n",
+        indent(outerIndent + 2), "var ", className, " = function(", member, ") {\n",
+        isReader
+        ? kj::strTree(indent(outerIndent + 4), "this._reader = _reader === undefined ? capnp.genhelper.NullStructReader : _reader;\n")
+        : kj::strTree(indent(outerIndent + 4), "this._builder = _builder;\n"),
+        indent(outerIndent + 2), "};\n",
+        isUnion ? kj::strTree(indent(outerIndent + 2), proto, "which = function() { return this.", member, ".getDataField_uint16(", structNode.getDiscriminantOffset(), "); };\n") : kj::strTree(),
+        kj::mv(methodDecls),
+        isReader
+        ? kj::strTree(
+            indent(outerIndent + 2), proto, "_getParentType = function() { return module.", fullName, "; };\n",
+            indent(outerIndent + 2), proto, "_getInnerReader = function() { return this._reader; };\n",
+            indent(outerIndent + 2), proto, "totalSizeInWords = function() { return this._reader.totalSize(); };\n",
+            indent(outerIndent + 2), proto, "_getReader = function() { return this._reader; };\n",
+            indent(outerIndent + 2), proto, "toObject = function() { return module.", fullName, ".toObject(this._reader); };\n")
+        : kj::strTree(
+            indent(outerIndent + 2), proto, "asReader = function() { return new module.", fullName, ".Reader(this._builder.asReader()); };\n",
+            indent(outerIndent + 2), proto, "getReader = function() { return this._builder.asReader(); };\n",
+            indent(outerIndent + 2), proto, "totalSizeInWords = function() { return this.asReader().totalSizeInWords(); };\n",
+            indent(outerIndent + 2), proto, "toObject = function() { return module.", fullName, ".toObject(this._builder.asReader()); };\n",
+            indent(outerIndent + 2), proto, "fromObject = function(obj) { module.", fullName, ".fromObject(this._builder, obj); };\n"),
+        indent(outerIndent + 2), proto, "GET_MEMBER = [", kj::StringTree(KJ_MAP(n, fieldNames) { return kj::strTree(proto, "get", toTitleCase(n)); }, ", ").flatten(), "];\n",
+        indent(outerIndent + 2), proto, "HAS_MEMBER = [", kj::StringTree(KJ_MAP(n, fieldNames) { return kj::strTree(proto, "has", toTitleCase(n)); }, ", ").flatten(), "];\n",
+        indent(outerIndent + 2), proto, "toString = function() { return capnp.genhelper.ToStringHelper(this, \"", name, ".", className, "\", module.", fullName, ".FIELD_LIST, this.HAS_MEMBER, this.GET_MEMBER",
+        isUnion? kj::strTree(", this.which()") : kj::strTree(""),
+        "); };\n",
+        indent(outerIndent + 2), "return ", className, ";\n",
+        indent(outerIndent), "}(),\n"
+        "\n");
+  }
+
   // -----------------------------------------------------------------
 
   struct ConstText {
@@ -1218,6 +1494,8 @@ private:
         auto structNode = proto.getStruct();
         uint discrimOffset = structNode.getDiscriminantOffset();
 
+        auto objectConversions = makeObjectConversions(schema.asStruct(), fieldTexts, outerIndent + 3);
+
         return NodeText {
           kj::str(),
 
@@ -1240,7 +1518,8 @@ private:
 
 
               makeReaderDef(schema, fullName, name, structNode.getDiscriminantCount() != 0,
-                            KJ_MAP(f, fieldTexts) { return kj::mv(f.readerMethodDecls); }, fieldNames, name, outerIndent + 3),
+                            KJ_MAP(f, fieldTexts) { return kj::mv(f.readerMethodDecls); }, fieldNames, name,
+                            kj::mv(objectConversions), outerIndent + 3),
               makeBuilderDef(schema, fullName, name, structNode.getDiscriminantCount() != 0,
                              KJ_MAP(f, fieldTexts) { return kj::mv(f.builderMethodDecls); }, fieldNames, name, outerIndent + 3),
 
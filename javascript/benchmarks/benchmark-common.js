@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+goog.provide('capnp.benchmarks.common');
+
+goog.require('capnp.blob');
+goog.require('capnp.message');
+goog.require('capnp.packed');
+goog.require('capnp.serialize');
+
+
+// Random number generator used by the benchmarks, same as upstream's fastRand().  The driver
+// calls resetRand() before each run so that every mode processes the same sequence of
+// messages.
+
+var randX, randY, randZ, randW;
+
+capnp.benchmarks.common.resetRand = function() {
+  randX = 0x1d2e3f4a;
+  randY = 0x97531f27;
+  randZ = 0xf1d7e1ab;
+  randW = 0x7fb3e62c;
+};
+
+capnp.benchmarks.common.resetRand();
+
+var nextFastRand = function() {
+  var tmp = randX ^ (randX << 11);
+  randX = randY;
+  randY = randZ;
+  randZ = randW;
+  randW = (randW ^ (randW >>> 19) ^ tmp ^ (tmp >>> 8)) >>> 0;
+  return randW;
+};
+
+/**
+ * @param {number} range
+ * @return {number} An integer in [0, range).
+ */
+capnp.benchmarks.common.fastRand = function(range) {
+  return nextFastRand() % range;
+};
+
+/**
+ * @param {number} range
+ * @return {number} A double in [0, range].
+ */
+capnp.benchmarks.common.fastRandDouble = function(range) {
+  return nextFastRand() * range / 0xffffffff;
+};
+
+/**
+ * UInt64 fields are read as [hi, lo] pairs, or as BigInt with `capnpc-js --bigint`.  The
+ * benchmark values always fit in a double.
+ */
+capnp.benchmarks.common.uint64ToNumber = function(value) {
+  return typeof value === 'bigint' ? Number(value) : value[0] * 0x100000000 + value[1];
+};
+
+capnp.benchmarks.common.numberToUint64 = function(value) {
+  return [Math.floor(value / 0x100000000), value >>> 0];
+};
+
+
+/**
+ * How messages travel between client and server.  JSON is the baseline: the same data as plain
+ * objects, sent through JSON.stringify() and JSON.parse().
+ */
+capnp.benchmarks.common.Mode = {
+  UNPACKED: 'unpacked',
+  PACKED: 'packed',
+  JSON: 'json'
+};
+
+/**
+ * Runs one request/response round trip of a test case per step():  the client builds a
+ * request, the server decodes it and builds a response, the client decodes and checks the
+ * response.  Both messages are serialized in between, as if sent over a pipe.
+ *
+ * A test case has setupRequest(request) returning the expected result,
+ * handleRequest(request, response), checkResponse(response, expected), RequestType and
+ * ResponseType, and the same three functions working on plain objects in `json`.
+ *
+ * With `reuse`, the two MessageBuilders are reset and reused for every round trip, drawing any
+ * extra segments from a shared SegmentPool.  Otherwise each message gets a new builder, as a
+ * naive client would do.
+ *
+ * @constructor
+ * @param {Object} testCase
+ * @param {string} mode One of capnp.benchmarks.common.Mode.
+ * @param {boolean} reuse
+ */
+capnp.benchmarks.common.Runner = function(testCase, mode, reuse) {
+  this.testCase = testCase;
+  this.mode = mode;
+  this.reuse = reuse;
+
+  // Totals over all round trips so far, for reporting bytes per message.
+  this.messageCount = 0;
+  this.byteCount = 0;
+
+  if (reuse) {
+    var pool = new capnp.message.SegmentPool();
+    this.requestBuilder = new capnp.message.MallocMessageBuilder(undefined, undefined, pool);
+    this.responseBuilder = new capnp.message.MallocMessageBuilder(undefined, undefined, pool);
+  }
+};
+
+/**
+ * @return {boolean} Whether the response was correct.
+ */
+capnp.benchmarks.common.Runner.prototype.step = function() {
+
+  var testCase = this.testCase;
+
+  if (this.mode === capnp.benchmarks.common.Mode.JSON) {
+    var requestObject = {};
+    var expected = testCase.json.setupRequest(requestObject);
+    var requestText = this._sendJson(requestObject);
+
+    var responseObject = {};
+    testCase.json.handleRequest(JSON.parse(requestText), responseObject);
+    var responseText = this._sendJson(responseObject);
+
+    return testCase.json.checkResponse(JSON.parse(responseText), expected);
+  }
+
+  var requestBuilder = this._getBuilder(this.requestBuilder);
+  var expected = testCase.setupRequest(requestBuilder.initRoot(testCase.RequestType));
+  var request = this._send(requestBuilder).getRoot(testCase.RequestType);
+
+  var responseBuilder = this._getBuilder(this.responseBuilder);
+  testCase.handleRequest(request, responseBuilder.initRoot(testCase.ResponseType));
+  var response = this._send(responseBuilder).getRoot(testCase.ResponseType);
+
+  return testCase.checkResponse(response, expected);
+};
+
+capnp.benchmarks.common.Runner.prototype._getBuilder = function(builder) {
+  if (builder) {
+    builder.reset();
+    return builder;
+  }
+  return new capnp.message.MallocMessageBuilder();
+};
+
+capnp.benchmarks.common.Runner.prototype._send = function(builder) {
+  var bytes;
+  if (this.mode === capnp.benchmarks.common.Mode.PACKED) {
+    var packed = capnp.packed.packToArrayBuffer(builder);
+    this._count(packed.byteLength);
+    bytes = capnp.packed.unpackFromArrayBuffer(packed);
+  }
+  else {
+    bytes = capnp.serialize.messageToFlatArray(builder.getSegmentsForOutput());
+    this._count(bytes.byteLength);
+  }
+  return new capnp.message.FlatArrayMessageReader(bytes);
+};
+
+capnp.benchmarks.common.Runner.prototype._sendJson = function(object) {
+  var text = JSON.stringify(object);
+  this._count(capnp.blob.utf8Length(text));
+  return text;
+};
+
+capnp.benchmarks.common.Runner.prototype._count = function(byteLength) {
+  this.messageCount += 1;
+  this.byteCount += byteLength;
+};
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+goog.provide('capnp.benchmarks');
+
+goog.require('capnp.benchmarks.common');
+goog.require('capnp.benchmarks.carsales');
+goog.require('capnp.benchmarks.catrank');
+goog.require('capnp.benchmarks.eval');
+
+// Entry point of the compiled benchmark bundle, see run.js.
+
+(function (exports) {
+
+  "use strict";
+
+  exports['cases'] = {
+    'carsales': capnp.benchmarks.carsales,
+    'catrank': capnp.benchmarks.catrank,
+    'eval': capnp.benchmarks.eval
+  };
+
+  exports['modes'] = [
+    capnp.benchmarks.common.Mode.JSON,
+    capnp.benchmarks.common.Mode.UNPACKED,
+    capnp.benchmarks.common.Mode.PACKED
+  ];
+
+  exports['resetRand'] = capnp.benchmarks.common.resetRand;
+
+  exports['Runner'] = capnp.benchmarks.common.Runner;
+  goog.exportSymbol('Runner.prototype.step', capnp.benchmarks.common.Runner.prototype.step, exports);
+
+})(typeof exports === 'undefined' ? this['capnp_benchmarks'] = {} : exports);
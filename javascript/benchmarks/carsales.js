@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+goog.provide('capnp.benchmarks.carsales');
+
+goog.require('capnp.benchmarks.common');
+
+// Generated from $(CAPNP_SOURCE)/src/capnp/benchmark/carsales.capnp.
+goog.require('capnp_generated_ff75ddc6a36723c9');
+
+
+// Port of capnproto-carsales.c++:  the client sends a parking lot full of random cars, the
+// server replies with their total value.
+
+(function() {
+
+  var carsales = capnp_generated_ff75ddc6a36723c9;
+  var fastRand = capnp.benchmarks.common.fastRand;
+  var fastRandDouble = capnp.benchmarks.common.fastRandDouble;
+
+  var MAKES = [ 'Toyota', 'GM', 'Ford', 'Honda', 'Tesla' ];
+  var MODELS = [ 'Camry', 'Prius', 'Volt', 'Accord', 'Leaf', 'Model S' ];
+
+  var carValue = function(car) {
+    // Do not think too hard about realism.
+
+    var result = 0;
+
+    result += car.getSeats() * 200;
+    result += car.getDoors() * 350;
+
+    var wheels = car.getWheels();
+    for (var i = 0, len = wheels.size(); i < len; ++i) {
+      var wheel = wheels.get(i);
+      result += wheel.getDiameter() * wheel.getDiameter();
+      result += wheel.getSnowTires() ? 100 : 0;
+    }
+
+    result += Math.floor(car.getLength() * car.getWidth() * car.getHeight() / 50);
+
+    var engine = car.getEngine();
+    result += engine.getHorsepower() * 40;
+    if (engine.getUsesElectric()) {
+      if (engine.getUsesGas()) {
+        // hybrid
+        result += 5000;
+      } else {
+        result += 3000;
+      }
+    }
+
+    result += car.getHasPowerWindows() ? 100 : 0;
+    result += car.getHasPowerSteering() ? 200 : 0;
+    result += car.getHasCruiseControl() ? 400 : 0;
+    result += car.getHasNavSystem() ? 2000 : 0;
+
+    result += car.getCupHolders() * 25;
+
+    return result;
+  };
+
+  var randomCar = function(car) {
+    // Do not think too hard about realism.
+
+    car.setMake(MAKES[fastRand(MAKES.length)]);
+    car.setModel(MODELS[fastRand(MODELS.length)]);
+
+    car.setColor(fastRand(carsales.Color.SILVER + 1));
+    car.setSeats(2 + fastRand(6));
+    car.setDoors(2 + fastRand(3));
+
+    var wheels = car.initWheels(4);
+    for (var i = 0; i < 4; ++i) {
+      var wheel = wheels.get(i);
+      wheel.setDiameter(25 + fastRand(15));
+      wheel.setAirPressure(30 + fastRandDouble(20));
+      wheel.setSnowTires(fastRand(16) === 0);
+    }
+
+    car.setLength(170 + fastRand(150));
+    car.setWidth(48 + fastRand(36));
+    car.setHeight(54 + fastRand(48));
+    car.setWeight(Math.floor(car.getLength() * car.getWidth() * car.getHeight() / 200));
+
+    var engine = car.initEngine();
+    engine.setHorsepower(100 * fastRand(400));
+    engine.setCylinders(4 + 2 * fastRand(3));
+    engine.setCc(800 + fastRand(10000));
+    engine.setUsesGas(true);
+    engine.setUsesElectric(fastRand(2) === 1);
+
+    car.setFuelCapacity(10.0 + fastRandDouble(30.0));
+    car.setFuelLevel(fastRandDouble(car.getFuelCapacity()));
+    car.setHasPowerWindows(fastRand(2) === 1);
+    car.setHasPowerSteering(fastRand(2) === 1);
+    car.setHasCruiseControl(fastRand(2) === 1);
+    car.setCupHolders(fastRand(12));
+    car.setHasNavSystem(fastRand(2) === 1);
+  };
+
+  // The same on plain objects, drawing the same random numbers in the same order.
+
+  var carValueJson = function(car) {
+    var result = 0;
+
+    result += car.seats * 200;
+    result += car.doors * 350;
+
+    var wheels = car.wheels;
+    for (var i = 0, len = wheels.length; i < len; ++i) {
+      var wheel = wheels[i];
+      result += wheel.diameter * wheel.diameter;
+      result += wheel.snowTires ? 100 : 0;
+    }
+
+    result += Math.floor(car.length * car.width * car.height / 50);
+
+    var engine = car.engine;
+    result += engine.horsepower * 40;
+    if (engine.usesElectric) {
+      if (engine.usesGas) {
+        result += 5000;
+      } else {
+        result += 3000;
+      }
+    }
+
+    result += car.hasPowerWindows ? 100 : 0;
+    result += car.hasPowerSteering ? 200 : 0;
+    result += car.hasCruiseControl ? 400 : 0;
+    result += car.hasNavSystem ? 2000 : 0;
+
+    result += car.cupHolders * 25;
+
+    return result;
+  };
+
+  var randomCarJson = function() {
+    var car = {};
+
+    car.make = MAKES[fastRand(MAKES.length)];
+    car.model = MODELS[fastRand(MODELS.length)];
+
+    car.color = fastRand(carsales.Color.SILVER + 1);
+    car.seats = 2 + fastRand(6);
+    car.doors = 2 + fastRand(3);
+
+    car.wheels = [];
+    for (var i = 0; i < 4; ++i) {
+      car.wheels.push({
+        diameter: 25 + fastRand(15),
+        airPressure: Math.fround(30 + fastRandDouble(20)),
+        snowTires: fastRand(16) === 0
+      });
+    }
+
+    car.length = 170 + fastRand(150);
+    car.width = 48 + fastRand(36);
+    car.height = 54 + fastRand(48);
+    car.weight = Math.floor(car.length * car.width * car.height / 200);
+
+    car.engine = {
+      horsepower: 100 * fastRand(400),
+      cylinders: 4 + 2 * fastRand(3),
+      cc: 800 + fastRand(10000),
+      usesGas: true,
+      usesElectric: fastRand(2) === 1
+    };
+
+    // Float32 fields, rounded the way the capnp message stores them.
+    car.fuelCapacity = Math.fround(10.0 + fastRandDouble(30.0));
+    car.fuelLevel = Math.fround(fastRandDouble(car.fuelCapacity));
+    car.hasPowerWindows = fastRand(2) === 1;
+    car.hasPowerSteering = fastRand(2) === 1;
+    car.hasCruiseControl = fastRand(2) === 1;
+    car.cupHolders = fastRand(12);
+    car.hasNavSystem = fastRand(2) === 1;
+
+    return car;
+  };
+
+  capnp.benchmarks.carsales = {
+
+    RequestType: carsales.ParkingLot,
+    ResponseType: carsales.TotalValue,
+
+    setupRequest: function(request) {
+      var result = 0;
+      var cars = request.initCars(fastRand(200));
+      for (var i = 0, len = cars.size(); i < len; ++i) {
+        var car = cars.get(i);
+        randomCar(car);
+        result += carValue(car);
+      }
+      return result;
+    },
+
+    handleRequest: function(request, response) {
+      var result = 0;
+      var cars = request.getCars();
+      for (var i = 0, len = cars.size(); i < len; ++i) {
+        result += carValue(cars.get(i));
+      }
+      response.setAmount(capnp.benchmarks.common.numberToUint64(result));
+    },
+
+    checkResponse: function(response, expected) {
+      return capnp.benchmarks.common.uint64ToNumber(response.getAmount()) === expected;
+    },
+
+    json: {
+
+      setupRequest: function(request) {
+        var result = 0;
+        var count = fastRand(200);
+        request.cars = [];
+        for (var i = 0; i < count; ++i) {
+          var car = randomCarJson();
+          request.cars.push(car);
+          result += carValueJson(car);
+        }
+        return result;
+      },
+
+      handleRequest: function(request, response) {
+        var result = 0;
+        var cars = request.cars;
+        for (var i = 0, len = cars.length; i < len; ++i) {
+          result += carValueJson(cars[i]);
+        }
+        response.amount = result;
+      },
+
+      checkResponse: function(response, expected) {
+        return response.amount === expected;
+      }
+    }
+  };
+
+})();
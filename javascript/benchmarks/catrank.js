@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+goog.provide('capnp.benchmarks.catrank');
+
+goog.require('capnp.benchmarks.common');
+
+// Generated from $(CAPNP_SOURCE)/src/capnp/benchmark/catrank.capnp.
+goog.require('capnp_generated_82beb8e37ff79aba');
+
+
+// Port of capnproto-catrank.c++:  the client sends a list of search results, the server boosts
+// the ones whose snippet mentions cats, demotes dogs and returns the results sorted by score.
+
+(function() {
+
+  var catrank = capnp_generated_82beb8e37ff79aba;
+  var fastRand = capnp.benchmarks.common.fastRand;
+
+  var URL_PREFIX = 'http://example.com/';
+
+  var WORDS = [
+    'foo ', 'bar ', 'baz ', 'qux ', 'quux ', 'corge ', 'grault ', 'garply ', 'waldo ', 'fred ',
+    'plugh ', 'xyzzy ', 'thud '
+  ];
+
+  // Draws one result's random content.  Both the capnp and the JSON variant use this so that
+  // they see the same data.
+  var randomResult = function() {
+    var urlSize = fastRand(100);
+    var url = URL_PREFIX;
+    for (var j = 0; j < urlSize; j++) {
+      url += String.fromCharCode(97 + fastRand(26));
+    }
+
+    var isCat = fastRand(8) === 0;
+    var isDog = fastRand(8) === 0;
+
+    var snippet = ' ';
+
+    var prefix = fastRand(20);
+    for (var j = 0; j < prefix; j++) {
+      snippet += WORDS[fastRand(WORDS.length)];
+    }
+
+    if (isCat) snippet += 'cat ';
+    if (isDog) snippet += 'dog ';
+
+    var suffix = fastRand(20);
+    for (var j = 0; j < suffix; j++) {
+      snippet += WORDS[fastRand(WORDS.length)];
+    }
+
+    return { url: url, snippet: snippet, good: isCat && !isDog };
+  };
+
+  var adjustScore = function(score, snippet) {
+    if (snippet.indexOf(' cat ') !== -1) score *= 10000;
+    if (snippet.indexOf(' dog ') !== -1) score /= 10000;
+    return score;
+  };
+
+  var byScoreDescending = function(a, b) {
+    return b.score - a.score;
+  };
+
+  capnp.benchmarks.catrank = {
+
+    RequestType: catrank.SearchResultList,
+    ResponseType: catrank.SearchResultList,
+
+    setupRequest: function(request) {
+      var count = fastRand(1000);
+      var goodCount = 0;
+
+      var list = request.initResults(count);
+
+      for (var i = 0; i < count; i++) {
+        var result = list.get(i);
+        result.setScore(1000 - i);
+
+        var content = randomResult();
+        result.setUrl(content.url);
+        result.setSnippet(content.snippet);
+        if (content.good) ++goodCount;
+      }
+
+      return goodCount;
+    },
+
+    handleRequest: function(request, response) {
+      var scoredResults = [];
+
+      var results = request.getResults();
+      for (var i = 0, len = results.size(); i < len; ++i) {
+        var result = results.get(i);
+        scoredResults.push({
+          score: adjustScore(result.getScore(), result.getSnippet().str()),
+          result: result
+        });
+      }
+
+      scoredResults.sort(byScoreDescending);
+
+      var list = response.initResults(scoredResults.length);
+      for (var i = 0, len = scoredResults.length; i < len; ++i) {
+        var item = list.get(i);
+        item.setScore(scoredResults[i].score);
+        item.setUrl(scoredResults[i].result.getUrl());
+        item.setSnippet(scoredResults[i].result.getSnippet());
+      }
+    },
+
+    checkResponse: function(response, expectedGoodCount) {
+      var goodCount = 0;
+      var results = response.getResults();
+      for (var i = 0, len = results.size(); i < len; ++i) {
+        if (results.get(i).getScore() > 1001) {
+          ++goodCount;
+        } else {
+          break;
+        }
+      }
+      return goodCount === expectedGoodCount;
+    },
+
+    json: {
+
+      setupRequest: function(request) {
+        var count = fastRand(1000);
+        var goodCount = 0;
+
+        request.results = [];
+
+        for (var i = 0; i < count; i++) {
+          var content = randomResult();
+          request.results.push({ url: content.url, score: 1000 - i, snippet: content.snippet });
+          if (content.good) ++goodCount;
+        }
+
+        return goodCount;
+      },
+
+      handleRequest: function(request, response) {
+        var scoredResults = [];
+
+        var results = request.results;
+        for (var i = 0, len = results.length; i < len; ++i) {
+          var result = results[i];
+          scoredResults.push({
+            url: result.url,
+            score: adjustScore(result.score, result.snippet),
+            snippet: result.snippet
+          });
+        }
+
+        scoredResults.sort(byScoreDescending);
+
+        response.results = scoredResults;
+      },
+
+      checkResponse: function(response, expectedGoodCount) {
+        var goodCount = 0;
+        var results = response.results;
+        for (var i = 0, len = results.length; i < len; ++i) {
+          if (results[i].score > 1001) {
+            ++goodCount;
+          } else {
+            break;
+          }
+        }
+        return goodCount === expectedGoodCount;
+      }
+    }
+  };
+
+})();
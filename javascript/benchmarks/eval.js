@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+goog.provide('capnp.benchmarks.eval');
+
+goog.require('capnp.benchmarks.common');
+
+// Generated from $(CAPNP_SOURCE)/src/capnp/benchmark/eval.capnp.
+goog.require('capnp_generated_e12dc4c3e70e9eda');
+
+
+// Port of capnproto-eval.c++:  the client sends a random arithmetic expression tree, the server
+// evaluates it.  All arithmetic is on int32, like in C++.
+
+(function() {
+
+  var evalSchema = capnp_generated_e12dc4c3e70e9eda;
+  var Operation = evalSchema.Operation;
+  var Expression = evalSchema.Expression;
+  var fastRand = capnp.benchmarks.common.fastRand;
+
+  var INT32_MAX = 0x7fffffff;
+  var INT32_MIN = -0x80000000;
+
+  var div = function(a, b) {
+    if (b === 0) return INT32_MAX;
+    // INT_MIN / -1 => SIGFPE.  Who knew?
+    if (a === INT32_MIN && b === -1) return INT32_MIN;
+    return (a / b) | 0;
+  };
+
+  var mod = function(a, b) {
+    if (b === 0) return INT32_MAX;
+    // INT_MIN % -1 => SIGFPE.  Who knew?
+    if (a === INT32_MIN && b === -1) return INT32_MIN;
+    return a % b;
+  };
+
+  var apply = function(op, left, right) {
+    switch (op) {
+      case Operation.ADD: return (left + right) | 0;
+      case Operation.SUBTRACT: return (left - right) | 0;
+      case Operation.MULTIPLY: return Math.imul(left, right);
+      case Operation.DIVIDE: return div(left, right);
+      case Operation.MODULUS: return mod(left, right);
+    }
+    throw new Error("Can't get here.");
+  };
+
+  var makeExpression = function(exp, depth) {
+    exp.setOp(fastRand(Operation.MODULUS + 1));
+
+    var left, right;
+
+    if (fastRand(8) < depth) {
+      left = fastRand(128) + 1;
+      exp.getLeft().setValue(left);
+    } else {
+      left = makeExpression(exp.getLeft().initExpression(), depth + 1);
+    }
+
+    if (fastRand(8) < depth) {
+      right = fastRand(128) + 1;
+      exp.getRight().setValue(right);
+    } else {
+      right = makeExpression(exp.getRight().initExpression(), depth + 1);
+    }
+
+    return apply(exp.getOp(), left, right);
+  };
+
+  var evaluateExpression = function(exp) {
+    var left, right;
+
+    var leftGroup = exp.getLeft();
+    if (leftGroup.which() === Expression.Left.VALUE) {
+      left = leftGroup.getValue();
+    } else {
+      left = evaluateExpression(leftGroup.getExpression());
+    }
+
+    var rightGroup = exp.getRight();
+    if (rightGroup.which() === Expression.Right.VALUE) {
+      right = rightGroup.getValue();
+    } else {
+      right = evaluateExpression(rightGroup.getExpression());
+    }
+
+    return apply(exp.getOp(), left, right);
+  };
+
+  // The same on plain objects:  { op, left: { value } or { expression }, right: ... }.
+
+  var makeExpressionJson = function(exp, depth) {
+    exp.op = fastRand(Operation.MODULUS + 1);
+
+    var left, right;
+
+    if (fastRand(8) < depth) {
+      left = fastRand(128) + 1;
+      exp.left = { value: left };
+    } else {
+      exp.left = { expression: {} };
+      left = makeExpressionJson(exp.left.expression, depth + 1);
+    }
+
+    if (fastRand(8) < depth) {
+      right = fastRand(128) + 1;
+      exp.right = { value: right };
+    } else {
+      exp.right = { expression: {} };
+      right = makeExpressionJson(exp.right.expression, depth + 1);
+    }
+
+    return apply(exp.op, left, right);
+  };
+
+  var evaluateExpressionJson = function(exp) {
+    var left = exp.left.expression ? evaluateExpressionJson(exp.left.expression) : exp.left.value;
+    var right = exp.right.expression ? evaluateExpressionJson(exp.right.expression) : exp.right.value;
+    return apply(exp.op, left, right);
+  };
+
+  capnp.benchmarks.eval = {
+
+    RequestType: Expression,
+    ResponseType: evalSchema.EvaluationResult,
+
+    setupRequest: function(request) {
+      return makeExpression(request, 0);
+    },
+
+    handleRequest: function(request, response) {
+      response.setValue(evaluateExpression(request));
+    },
+
+    checkResponse: function(response, expected) {
+      return response.getValue() === expected;
+    },
+
+    json: {
+
+      setupRequest: function(request) {
+        return makeExpressionJson(request, 0);
+      },
+
+      handleRequest: function(request, response) {
+        response.value = evaluateExpressionJson(request);
+      },
+
+      checkResponse: function(response, expected) {
+        return response.value === expected;
+      }
+    }
+  };
+
+})();
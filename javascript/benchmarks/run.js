@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Benchmark driver for Node.js.  Loads the compiled benchmark bundle (see run-benchmarks.sh)
+// and runs every test case in every mode on the same sequence of messages.
+//
+//   node --expose-gc run.js BUNDLE [--iters N] [--case NAME] [--mode MODE] [--json]
+//
+// For each run it reports round trips per second, the average serialized size of a message and
+// the heap allocated per round trip.  Allocation is measured as the growth of the JS heap plus
+// ArrayBuffer memory over short batches starting right after a full GC.  Batches during which
+// the garbage collector ran anyway are discarded and the batch size is halved, and the median of
+// the remaining batches is reported.  It needs --expose-gc and is approximate.
+
+'use strict';
+
+var path = require('path');
+var v8 = require('v8');
+
+var usage = function() {
+  console.error('usage: node --expose-gc run.js BUNDLE [--iters N] [--case NAME] [--mode MODE] [--json]');
+  process.exit(1);
+};
+
+var args = process.argv.slice(2);
+if (args.length < 1) usage();
+
+var bench = require(path.resolve(args[0]));
+
+var options = { iters: 0, cases: null, modes: null, json: false };
+for (var i = 1; i < args.length; i++) {
+  switch (args[i]) {
+    case '--iters': options.iters = parseInt(args[++i], 10); break;
+    case '--case': options.cases = (options.cases || []).concat(args[++i]); break;
+    case '--mode': options.modes = (options.modes || []).concat(args[++i]); break;
+    case '--json': options.json = true; break;
+    default: usage();
+  }
+}
+
+// Default iteration counts, picked so that each run takes about a second.
+var DEFAULT_ITERS = { 'carsales': 2000, 'catrank': 200, 'eval': 20000 };
+
+var HEAP_BATCH = 20;
+var HEAP_SAMPLES = 20;
+
+var allocatedBytes = function() {
+  var usage = process.memoryUsage();
+  return usage.heapUsed + usage.arrayBuffers;
+};
+
+var runSteps = function(runner, count, name) {
+  for (var i = 0; i < count; i++) {
+    if (!runner.step()) {
+      throw new Error(name + ': got wrong response');
+    }
+  }
+};
+
+// Runs count steps and returns the growth of allocatedBytes(), or null if the garbage collector
+// ran in between and the growth says nothing about what was allocated.
+var measureBatch = function(runner, count, name) {
+  // GCProfiler (Node.js 18.15 and later) reports every collection.  Without it, only collections
+  // that shrink the heap are noticed.
+  var profiler = typeof v8.GCProfiler === 'function' ? new v8.GCProfiler() : null;
+  if (profiler) {
+    profiler.start();
+  }
+  var heapBefore = v8.getHeapStatistics().used_heap_size;
+  var before = allocatedBytes();
+
+  runSteps(runner, count, name);
+
+  var growth = allocatedBytes() - before;
+  var collected = profiler ? profiler.stop().statistics.length > 0
+                           : v8.getHeapStatistics().used_heap_size < heapBefore;
+  return collected ? null : growth;
+};
+
+var measureHeap = function(runner, name) {
+  if (typeof global.gc !== 'function') {
+    return null;
+  }
+
+  var batch = HEAP_BATCH;
+  var samples = [];
+  for (var i = 0; i < HEAP_SAMPLES * 4 && samples.length < HEAP_SAMPLES; i++) {
+    global.gc();
+    var growth = measureBatch(runner, batch, name);
+    if (growth === null) {
+      // Try to fit the next batch into the young generation.
+      batch = Math.max(1, batch >> 1);
+    } else {
+      samples.push(growth / batch);
+    }
+  }
+
+  if (samples.length === 0) {
+    return null;
+  }
+
+  samples.sort(function(a, b) { return a - b; });
+  return samples[samples.length >> 1];
+};
+
+var run = function(caseName, mode, reuse) {
+  var testCase = bench.cases[caseName];
+  var iters = options.iters || DEFAULT_ITERS[caseName];
+  var name = caseName + ' ' + mode + (reuse ? ' reuse' : '');
+
+  bench.resetRand();
+  var runner = new bench.Runner(testCase, mode, reuse);
+
+  // Warm up the JIT, then reset so that the timed part sees the same messages in every mode.
+  runSteps(runner, Math.max(1, iters >> 3), name);
+  bench.resetRand();
+  runner.messageCount = 0;
+  runner.byteCount = 0;
+
+  var start = process.hrtime.bigint();
+  runSteps(runner, iters, name);
+  var seconds = Number(process.hrtime.bigint() - start) / 1e9;
+
+  var result = {
+    'case': caseName,
+    'mode': mode,
+    'reuse': reuse,
+    'iterations': iters,
+    'opsPerSec': iters / seconds,
+    'bytesPerMessage': runner.byteCount / runner.messageCount,
+    'heapBytesPerOp': measureHeap(runner, name)
+  };
+
+  if (options.json) {
+    console.log(JSON.stringify(result));
+  } else {
+    console.log(pad(caseName, 10) + pad(mode + (reuse ? '+reuse' : ''), 16) +
+                pad(result.opsPerSec.toFixed(0), 12, true) + ' ops/s' +
+                pad(result.bytesPerMessage.toFixed(0), 10, true) + ' B/msg' +
+                pad(result.heapBytesPerOp === null ? 'n/a' : result.heapBytesPerOp.toFixed(0), 12, true) + ' B/op heap');
+  }
+};
+
+var pad = function(str, width, right) {
+  str = String(str);
+  while (str.length < width) {
+    str = right ? ' ' + str : str + ' ';
+  }
+  return str;
+};
+
+var caseNames = options.cases || Object.keys(bench.cases);
+var modes = options.modes || bench.modes;
+
+caseNames.forEach(function(caseName) {
+  if (!bench.cases.hasOwnProperty(caseName)) {
+    throw new Error('unknown benchmark: ' + caseName);
+  }
+  modes.forEach(function(mode) {
+    if (bench.modes.indexOf(mode) === -1) {
+      throw new Error('unknown mode: ' + mode);
+    }
+    run(caseName, mode, false);
+    if (mode !== 'json') {
+      run(caseName, mode, true);
+    }
+  });
+});
@@ -13,26 +13,49 @@ srcdir=$(dirname $0)
 
 python $closure_library/closure/bin/build/closurebuilder.py --root=$capnproto_js/javascript/lib/ --root=$closure_library/ --namespace='capnp.runtime' --output_mode=compiled  --compiler_jar=$compiler_jar --compiler_flags="--compilation_level=ADVANCED_OPTIMIZATIONS" > dist/capnp_runtime.js
 
-python $closure_library/closure/bin/build/closurebuilder.py \
-    --root=$capnproto_js/javascript/lib/ \
-    --root=$capnproto_js/javascript/tests/ \
-    --root=$closure_library/ \
-    --root=src/capnp \
-    --namespace='capnp.tests.encoding' \
-    --namespace='capnp.tests.serialize' \
-    --namespace='capnp.tests.packed' \
-    --namespace='capnp.tests.layout' \
-    --namespace='capnp.tests.stringify' \
-    --namespace='capnp.tests.orphans' \
-    --output_mode=compiled \
-    --compiler_jar=$compiler_jar \
-    --compiler_flags="--compilation_level=SIMPLE_OPTIMIZATIONS" \
-    --compiler_flags="--language_in=ECMASCRIPT5" \
-    --compiler_flags="--use_types_for_optimization" \
-    --compiler_flags="--formatting=PRETTY_PRINT" \
-    > dist/capnp_tests.js
-
-    #--compiler_flags="--warning_level=VERBOSE" \
+# Usage: build_tests <output> <language_out> <directory with generated test schemas> <test namespace>...
+build_tests() {
+  output=$1
+  language_out=$2
+  schemas=$3
+  shift 3
+  namespaces=
+  for namespace in "$@"; do
+    namespaces="$namespaces --namespace=$namespace"
+  done
+
+  python $closure_library/closure/bin/build/closurebuilder.py \
+      --root=$capnproto_js/javascript/lib/ \
+      --root=$capnproto_js/javascript/tests/ \
+      --root=$closure_library/ \
+      --root=$schemas \
+      $namespaces \
+      --output_mode=compiled \
+      --compiler_jar=$compiler_jar \
+      --compiler_flags="--compilation_level=SIMPLE_OPTIMIZATIONS" \
+      --compiler_flags="--language_in=ECMASCRIPT_2020" \
+      --compiler_flags="--language_out=$language_out" \
+      --compiler_flags="--use_types_for_optimization" \
+      --compiler_flags="--formatting=PRETTY_PRINT" \
+      > $output
+
+      #--compiler_flags="--warning_level=VERBOSE" \
+}
+
+build_tests dist/capnp_tests.js ECMASCRIPT5 src/capnp \
+    capnp.tests.encoding \
+    capnp.tests.serialize \
+    capnp.tests.packed \
+    capnp.tests.layout \
+    capnp.tests.stringify \
+    capnp.tests.orphans
+
+# The encoding tests once more against the schemas generated with capnpc-js --prototypes.
+build_tests dist/capnp_tests_prototypes.js ECMASCRIPT5 src-prototypes/capnp capnp.tests.encoding
+
+# The BigInt tests against the schemas generated with capnpc-js --bigint.  The generated code uses
+# BigInt literals, which Closure can't lower to older language versions.
+build_tests dist/capnp_tests_bigint.js ECMASCRIPT_2020 src-bigint/capnp capnp.tests.bigint
 
 #export NODE_PATH=${NODEPATH}:${builddir}/src/capnp:${builddir}/src:${builddir}/dist
 #mocha --bail ${srcdir}/../javascript/tests/
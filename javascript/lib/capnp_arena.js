@@ -52,7 +52,8 @@ capnp.arena.SegmentReader = function(arena, id, segment, readLimiter) {
 
   this.createWirePointerAt = function(offset) {
     goog.asserts.assert(kj.util.isRegularNumber(offset) && offset >= 0);
-    return new capnp.layout.WirePointer(offset, this.createSubDataView(offset, 8));
+    goog.asserts.assert(offset + 8 <= segment.byteLength);
+    return new capnp.layout.WirePointer(offset, segment);
   };
 
   this.containsInterval = function(start, end) {
@@ -137,6 +138,12 @@ capnp.arena.SegmentBuilder = function(arena, id, segment, readLimiter) {
     return this.createSubDataView(0, pos);
   };
 
+  this.reset = function() {
+    // Only the allocated prefix can have been written to.
+    this.getUint8Array().fill(0, 0, pos);
+    pos = 0;
+  };
+
   this.toString = function() {
     return 'SegmentBuilder{id=' + id + '}';
   };
@@ -181,6 +188,10 @@ capnp.arena.BuilderArena = function(message) {
     }
   };
 
+  // The word offset of the most recent allocation.  allocate() returns the segment and leaves
+  // the offset here, so that it doesn't need to create a result object.
+  this.allocatedWords = 0;
+
   this.allocate = function(amount) {
 
     if (!segment0) {
@@ -188,21 +199,25 @@ capnp.arena.BuilderArena = function(message) {
 
       var ptr = message.allocateSegment(amount);
       segment0 = new capnp.arena.SegmentBuilder(this, 0, ptr, dummyLimiter);
-      return { segment: segment0, words: segment0.allocate(amount) };
+      this.allocatedWords = segment0.allocate(amount);
+      return segment0;
     }
     else {
       // Check if there is space in the first segment.  We can do this without locking.
       var attempt = segment0.allocate(amount);
       if (attempt !== null) {
-        return { segment: segment0, words: attempt };
+        this.allocatedWords = attempt;
+        return segment0;
       }
 
       // Need to fall back to additional segments.
 
       if (builders.length > 0) {
-        attempt = builders[builders.length - 1].allocate(amount);
+        var lastBuilder = builders[builders.length - 1];
+        attempt = lastBuilder.allocate(amount);
         if (attempt !== null) {
-          return { segment: builders[builders.length - 1], words: attempt };
+          this.allocatedWords = attempt;
+          return lastBuilder;
         }
       }
 
@@ -211,8 +226,22 @@ capnp.arena.BuilderArena = function(message) {
 
       // Allocating from the new segment is guaranteed to succeed since no other thread could have
       // received a pointer to it yet (since we still hold the lock).
-      return { segment: newBuilder, words: newBuilder.allocate(amount) };
+      this.allocatedWords = newBuilder.allocate(amount);
+      return newBuilder;
+    }
+  };
+
+  this.reset = function() {
+    // Zero what was used and start over.  The first segment is kept, any others are handed back
+    // to the message for reuse.
+    if (segment0) {
+      segment0.reset();
+    }
+    for (var i = 0, len = builders.length; i < len; i++) {
+      builders[i].reset();
+      message.returnSegment(builders[i].getDataView());
     }
+    builders = [];
   };
 
   this.getSegmentsForOutput = function() {
@@ -25,6 +25,8 @@
 
 goog.provide('capnp.blob');
 
+goog.require('goog.asserts');
+
 goog.require('kj.util');
 
 capnp.blob.Text = {
@@ -56,120 +58,182 @@ capnp.blob.Text = {
     return builder.getTextBlobField(index, defaultValue, defaultBytes);
   },
 
-  Builder:
-  /**
-   * @constructor
-   */
-  function(segment, ptr, size) {
+  getOrphan: function(builder) {
+    return builder.asText();
+  },
 
-    this.toDebugString = function() {
-      return 'Text.Builder{ptr=' + ptr + ', size=' + size +
-        ', str="' + this.str() + '"}';
-    };
+  getOrphanReader: function(builder) {
+    return builder.asTextReader();
+  },
 
-    this.toString = function() { return this.str(); };
+  getNewOrphanList: function(arena, size) {
+    return capnp.layout.OrphanBuilder.initText(arena, size);
+  }
+};
 
-    this.begin = function() { return ptr * 8; };
+/**
+ * Shared UTF-8 codec instances.  Neither holds any per-call state (we never
+ * use the streaming mode), so a single instance of each is enough.
+ */
+var textDecoder = new TextDecoder('utf-8');
+var textEncoder = new TextEncoder();
 
-    this.size = function() { return size; };
+/**
+ * @param {string} str
+ * @return {number} The number of bytes TextEncoder will produce for str.
+ */
+capnp.blob.utf8Length = function(str) {
+  var len = str.length;
+  var result = len;
+  for (var i = 0; i < len; ++i) {
+    var c = str.charCodeAt(i);
+    if (c < 0x80) {
+      continue;
+    }
+    else if (c < 0x800) {
+      result += 1;
+    }
+    else if (c >= 0xd800 && c <= 0xdbff && i + 1 < len &&
+             (str.charCodeAt(i + 1) & 0xfc00) === 0xdc00) {
+      // Surrogate pair: two UTF-16 units, four UTF-8 bytes.
+      result += 2;
+      ++i;
+    }
+    else {
+      // Includes lone surrogates, which get encoded as U+FFFD.
+      result += 2;
+    }
+  }
+  return result;
+};
 
-    this.str = function() {
+/**
+ * Encodes str into target, which must be exactly utf8Length(str) bytes long.
+ *
+ * @param {string} str
+ * @param {Uint8Array} target
+ */
+capnp.blob.encodeUtf8Into = function(str, target) {
+  var result = textEncoder.encodeInto(str, target);
+  goog.asserts.assert(result.written === target.length,
+                      'encodeUtf8Into wrote ' + result.written + ' bytes, expected ' + target.length);
+};
 
-      var pad = function(n) {
-        return n.length < 2 ? '0' + n : n;
-      };
+/**
+ * @param {Uint8Array} bytes
+ * @return {string}
+ */
+capnp.blob.decodeUtf8 = function(bytes) {
+  return textDecoder.decode(bytes);
+};
 
-      var str = '';
-      var dataView = segment.getUint8Array();
-      for (var i = ptr * 8, end = ptr * 8 + size; i < end; ++i) {
-        str += ('%' + pad(dataView[i].toString(16)));
-      }
+/**
+ * @param {Object} data A Data reader or builder.
+ * @return {Uint8Array} A copy of its bytes that doesn't alias the message.
+ */
+capnp.blob.copyDataBytes = function(data) {
+  var size = data.size();
+  var bytes = data.asUint8Array();
+  if (size === 0 || !bytes) {
+    return new Uint8Array(0);
+  }
+  if (bytes instanceof ArrayBuffer) {
+    // Default values come straight from the schema.
+    bytes = new Uint8Array(bytes, 0, size);
+  }
+  return bytes.slice(0, size);
+};
 
-      return decodeURIComponent(str);
-    };
 
+/**
+ * @constructor
+ */
+capnp.blob.Text.Builder = function(segment, ptr, size) {
+  this.segment = segment;
+  this.ptr = ptr;
+  this._size = size;
+};
 
-    this.asUint8Array = function() {
-      return segment.getUint8Array().subarray(ptr * 8,
-                                              ptr * 8 + size);
-    };
+capnp.blob.Text.Builder.prototype.toDebugString = function() {
+  return 'Text.Builder{ptr=' + this.ptr + ', size=' + this._size +
+    ', str="' + this.str() + '"}';
+};
 
-    this.getOrphan = function(builder) {
-      return builder.asText();
-    };
+capnp.blob.Text.Builder.prototype.toString = function() { return this.str(); };
 
-    this.getOrphanReader = function(builder) {
-      return builder.asTextReader();
-    };
+capnp.blob.Text.Builder.prototype.begin = function() { return this.ptr * 8; };
 
-    this.getNewOrphanList = function(arena, size) {
-      return capnp.layout.OrphanBuilder.initText(arena, size);
-    };
+capnp.blob.Text.Builder.prototype.size = function() { return this._size; };
 
-    return this;
-  },
+capnp.blob.Text.Builder.prototype.str = function() {
+  // Not cached, the underlying bytes may be modified through asUint8Array().
+  if (this._size === 0) {
+    return '';
+  }
+  return capnp.blob.decodeUtf8(this.asUint8Array());
+};
 
-  Reader:
-  /**
-   * @constructor
-   */
-  function(segment, offset, numElements) {
+capnp.blob.Text.Builder.prototype.asUint8Array = function() {
+  return this.segment.getUint8Array().subarray(this.ptr * 8,
+                                               this.ptr * 8 + this._size);
+};
 
-    goog.asserts.assert(kj.util.isRegularNumber(numElements), 'invalid Reader.numElements: ' + numElements);
 
-    this.totalSizeInWords = 1;
+/**
+ * @constructor
+ */
+capnp.blob.Text.Reader = function(segment, offset, numElements) {
 
-    goog.asserts.assert(numElements === 0 || segment !== null);
+  goog.asserts.assert(kj.util.isRegularNumber(numElements), 'invalid Reader.numElements: ' + numElements);
+  goog.asserts.assert(numElements === 0 || segment !== null);
 
-    return new (function() {
-      this.str = function() {
+  this.segment = segment;
+  this.offset = offset;
+  this.numElements = numElements;
 
-        if (numElements === 0) {
-          return '';
-        }
-        else {
-          var pad = function(n) {
-            return n.length < 2 ? '0' + n : n;
-          };
-
-          var str = '';
-          var dataView = segment.getUint8Array();
-          for (var i = offset * 8,
-               end = offset * 8 + numElements; i < end; ++i) {
-            str += ('%' + pad(dataView[i].toString(16)));
-          }
+  // Decoded lazily by str(); the underlying bytes are immutable.
+  this._str = null;
+};
 
-          return decodeURIComponent(str);
-        }
-      };
+capnp.blob.Text.Reader.prototype.str = function() {
+  if (this._str === null) {
+    this._str = this.numElements === 0 ? '' : capnp.blob.decodeUtf8(this.asUint8Array());
+  }
+  return this._str;
+};
 
-      this.raw = function() {
-        var dataView = segment;
-        return new DataView(dataView.buffer,
-                            dataView.byteOffset + offset,
-                            numElements);
-      };
+capnp.blob.Text.Reader.prototype.size = function() {
+  return this.numElements;
+};
 
-      this.toString = function() {
-        return this.str();
-      };
-      this.toDebugString = function() {
-        return 'Text{offset=' + offset +
-          ', numElements=' + numElements +
-          ', str="' + this.str() + '"}';
-      };
+capnp.blob.Text.Reader.prototype.asUint8Array = function() {
+  if (this.numElements === 0) {
+    return new Uint8Array(0);
+  }
+  return this.segment.getUint8Array().subarray(this.offset * 8,
+                                               this.offset * 8 + this.numElements);
+};
 
-      this._getParentType = function() {
-        return capnp.blob.Text;
-      };
+capnp.blob.Text.Reader.prototype.raw = function() {
+  return this.segment.createSubDataView(this.offset * 8, this.numElements);
+};
 
-      this._getInnerReader = function() {
-        return this;
-      };
+capnp.blob.Text.Reader.prototype.toString = function() {
+  return this.str();
+};
 
-      return this;
-    });
-  }
+capnp.blob.Text.Reader.prototype.toDebugString = function() {
+  return 'Text{offset=' + this.offset +
+    ', numElements=' + this.numElements +
+    ', str="' + this.str() + '"}';
+};
+
+capnp.blob.Text.Reader.prototype._getParentType = function() {
+  return capnp.blob.Text;
+};
+
+capnp.blob.Text.Reader.prototype._getInnerReader = function() {
+  return this;
 };
 
 capnp.blob.Data = {
@@ -314,23 +378,33 @@ capnp.blob.Data = {
 };
 
 /**
+ * Wraps a JavaScript string so that it can be used where a Text reader is
+ * expected.  The UTF-8 encoding is only materialized if asUint8Array() is
+ * called; setTextPointer() encodes the string straight into the message.
+ *
  * @constructor
  */
 capnp.blob.StringTextReader = function(str) {
-  var strUtf8 = unescape(encodeURIComponent(str));
-  var ab = new Uint8Array(strUtf8.length);
-  for (var i = 0; i < strUtf8.length; i++) {
-    ab[i] = strUtf8.charCodeAt(i);
+  this._str = str;
+  this._size = capnp.blob.utf8Length(str);
+  this._bytes = null;
+};
+
+capnp.blob.StringTextReader.prototype.str = function() { return this._str; };
+capnp.blob.StringTextReader.prototype.toString = function() { return this._str; };
+capnp.blob.StringTextReader.prototype.size = function() { return this._size; };
+
+capnp.blob.StringTextReader.prototype.asUint8Array = function() {
+  if (this._bytes === null) {
+    this._bytes = textEncoder.encode(this._str);
   }
+  return this._bytes;
+};
 
-  this.asUint8Array = function() { return ab; };
-  this.size = function() { return ab.byteLength; };
-  this._getParentType = function() {
-    return capnp.blob.Text;
-  };
-  this._getInnerReader = function() {
-    return this;
-  };
+capnp.blob.StringTextReader.prototype._getParentType = function() {
+  return capnp.blob.Text;
+};
 
+capnp.blob.StringTextReader.prototype._getInnerReader = function() {
   return this;
 };
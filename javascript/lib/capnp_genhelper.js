@@ -37,12 +37,8 @@ goog.require('kj.util')
  *  @param {number} index
  */
 capnp.genhelper.textBlobSet = function(builder, index, value) {
-  if (kj.util.isString(value)) {
-    builder.setTextBlobField(index, new capnp.blob.StringTextReader(value));
-  }
-  else {
-    builder.setTextBlobField(index, value);
-  }
+  // Strings are accepted as-is and encoded directly into the message.
+  builder.setTextBlobField(index, value);
 };
 
 capnp.genhelper.textBlobDisown = function(builder, index) {
@@ -88,6 +84,9 @@ capnp.genhelper.listSet = function(listClass, builder, index, value) {
       l.set(i, value[i]);
     }
   }
+  else if (ArrayBuffer.isView(value)) {
+    listClass.initFrom(builder, index, value);
+  }
   else {
     builder.setListField(index, value.getReader());
   }
@@ -149,9 +148,6 @@ capnp.genhelper.objectSet = function(type, builder, index, value) {
     }
   }
   else if (type === capnp.blob.Text) {
-    if (kj.util.isString(value)) {
-      value = new capnp.blob.StringTextReader(value);
-    }
     builder.setTextBlobField(index, value);
   }
   else if (type === capnp.blob.Data) {
@@ -222,7 +218,7 @@ capnp.genhelper.ConstText = function(segmentData, offset, numElements) {
   var segment = new capnp.arena.SegmentReader(null, null, new DataView(segmentData), null);
 
   this.get = function() {
-    return capnp.blob.Text.Reader(segment, offset, numElements);
+    return new capnp.blob.Text.Reader(segment, offset, numElements);
   };
   return this;
 };
@@ -219,11 +219,10 @@ var copyMessage = function(segment, dst, srcSegment, src) {
       return [segment, dst, null];
     } else {
       var srcPtr = src.target();
-      var allocateResult = capnp.layout.allocate(
+      var dstPtr = capnp.layout.allocate(
         dst, segment, src.getStructRef().wordSize(), capnp.layout.Kind.STRUCT, null);
-      var dstPtr = allocateResult[0];
-      segment = allocateResult[1];
-      dst = allocateResult[2];
+      segment = allocatedSegment;
+      dst = allocatedRef;
 
       copyStruct(segment, dstPtr, srcSegment, srcPtr, src.getStructRef().dataSize(),
                  src.getStructRef().ptrCount());
@@ -243,10 +242,9 @@ var copyMessage = function(segment, dst, srcSegment, src) {
       var wordCount = capnp.common.roundBitsUpToWords(
         src.getListRef().elementCount() * capnp.layout.dataBitsPerElement(src.getListRef().elementSize()));
       var srcPtr = src.target();
-      var allocateResult = capnp.layout.allocate(dst, segment, wordCount, capnp.layout.Kind.LIST, null);
-      var dstPtr = allocateResult[0];
-      segment = allocateResult[1];
-      dst = allocateResult[2];
+      var dstPtr = capnp.layout.allocate(dst, segment, wordCount, capnp.layout.Kind.LIST, null);
+      segment = allocatedSegment;
+      dst = allocatedRef;
 
       var dstUint8Array = segment.getUint8Array();
       var srcUint8Array = srcSegment.getUint8Array();
@@ -258,11 +256,10 @@ var copyMessage = function(segment, dst, srcSegment, src) {
 
     case capnp.layout.FieldSize.POINTER: {
 
-      var allocateResult = capnp.layout.allocate(dst, segment, src.getListRef().elementCount() * capnp.common.WORDS_PER_POINTER,
-                                                 capnp.layout.Kind.LIST, null);
-      var dstRefs = allocateResult[0];
-      segment = allocateResult[1];
-      dst = allocateResult[2];
+      var dstRefs = capnp.layout.allocate(dst, segment, src.getListRef().elementCount() * capnp.common.WORDS_PER_POINTER,
+                                          capnp.layout.Kind.LIST, null);
+      segment = allocatedSegment;
+      dst = allocatedRef;
 
       var n = src.getListRef().elementCount();
       for (var i = 0; i < n; i++) {
@@ -276,12 +273,11 @@ var copyMessage = function(segment, dst, srcSegment, src) {
 
     case capnp.layout.FieldSize.INLINE_COMPOSITE: {
       var srcPtr = src.target();
-      var allocateResult = capnp.layout.allocate(dst, segment,
-                                                 src.getListRef().inlineCompositeWordCount() + capnp.common.POINTER_SIZE_IN_WORDS,
-                                                 capnp.layout.Kind.LIST, null);
-      var dstPtr = allocateResult[0];
-      segment = allocateResult[1];
-      dst = allocateResult[2];
+      var dstPtr = capnp.layout.allocate(dst, segment,
+                                         src.getListRef().inlineCompositeWordCount() + capnp.common.POINTER_SIZE_IN_WORDS,
+                                         capnp.layout.Kind.LIST, null);
+      segment = allocatedSegment;
+      dst = allocatedRef;
 
       dst.setListRefInlineComposite(src.getListRef().inlineCompositeWordCount());
 
@@ -335,10 +331,11 @@ var transferPointerWithSrcPtr = function(dstSegment, dst, srcSegment, srcTag, sr
     var allocateResult = srcSegment.allocate(1);
     if (allocateResult === null) {
       // Darn, need a double-far.
-      var allocation = srcSegment.getArena().allocate(2);
-      var farSegment = allocation.segment;
-      var landingPad0 = farSegment.createWirePointerAt((allocation.words + 0) << 3);
-      var landingPad1 = farSegment.createWirePointerAt((allocation.words + 1) << 3);
+      var arena = srcSegment.getArena();
+      var farSegment = arena.allocate(2);
+      var farWords = arena.allocatedWords;
+      var landingPad0 = farSegment.createWirePointerAt((farWords + 0) << 3);
+      var landingPad1 = farSegment.createWirePointerAt((farWords + 1) << 3);
 
       landingPad0.setFar(false, srcPtr);
       landingPad0.setFarRef(srcSegment.getSegmentId());
@@ -346,7 +343,7 @@ var transferPointerWithSrcPtr = function(dstSegment, dst, srcSegment, srcTag, sr
       landingPad1.setKindWithZeroOffset(srcTag.kind());
       landingPad1.setUpper32Bits(srcTag.getUpper32Bits());
 
-      dst.setFar(true, allocation.words);
+      dst.setFar(true, farWords);
       dst.setFarRef(farSegment.getSegmentId());
 
     } else {
@@ -428,155 +425,167 @@ capnp.layout.Kind = {
  *  @param {number} ptrCount
  */
 capnp.layout.StructRef = function(dataSize, ptrCount) {
-  this.dataSize = function() { return dataSize; };
-  this.ptrCount = function() { return ptrCount; };
-  this.wordSize = function() { return dataSize + ptrCount * capnp.common.WORDS_PER_POINTER; };
-  this.toString = function() { return 'StructRef{dataSize=' + dataSize + ',ptrCount=' + ptrCount + '}'; };
+  this._dataSize = dataSize;
+  this._ptrCount = ptrCount;
 };
 
+capnp.layout.StructRef.prototype.dataSize = function() { return this._dataSize; };
+capnp.layout.StructRef.prototype.ptrCount = function() { return this._ptrCount; };
+capnp.layout.StructRef.prototype.wordSize = function() { return this._dataSize + this._ptrCount * capnp.common.WORDS_PER_POINTER; };
+capnp.layout.StructRef.prototype.toString = function() { return 'StructRef{dataSize=' + this._dataSize + ',ptrCount=' + this._ptrCount + '}'; };
+
 /**
  * @constructor
  *  @param {number} elementSize
  *  @param {number} elementCount
  */
 capnp.layout.ListRef = function(elementSize, elementCount) {
-  this.elementSize = function() { return elementSize; };
-  this.elementCount = function() { return elementCount; };
-  this.inlineCompositeWordCount = function() { return elementCount; };
+  this._elementSize = elementSize;
+  this._elementCount = elementCount;
 };
 
+capnp.layout.ListRef.prototype.elementSize = function() { return this._elementSize; };
+capnp.layout.ListRef.prototype.elementCount = function() { return this._elementCount; };
+capnp.layout.ListRef.prototype.inlineCompositeWordCount = function() { return this._elementCount; };
+
 /**
+ *  A pointer stored at byte offset `baseOffset' within `dataView'.
+ *  `dataView' is normally the whole segment, so creating a
+ *  WirePointer doesn't need to create a new DataView.
+ *
  *  @constructor
  *  @param {number} baseOffset
+ *  @param {DataView} dataView
  */
 capnp.layout.WirePointer = function(baseOffset, dataView) {
 
   goog.asserts.assert(kj.util.isRegularNumber(baseOffset));
   goog.asserts.assert(kj.util.isDataView(dataView), 'WirePointer constructor got invalid dataView: ', dataView);
 
-  this.getByteOffset = function() {
-    return baseOffset;
-  };
-
-  this.asPointer = function() {
-    return baseOffset >> 3;
-  };
-
-  this.getOffsetAndKind = function() {
-    return dataView.getUint32(0, true);
-  };
-
-  this.setOffsetAndKind = function(offsetAndKind) {
-    dataView.setUint32(0, offsetAndKind, true);
-  };
-
-  this.setKindWithZeroOffset = function(kind) {
-    this.setOffsetAndKind(kind);
-  };
-
-  this.getUpper32Bits = function() {
-    return dataView.getUint32(4, true);
-  };
-
-  this.setUpper32Bits = function(upper32bits) {
-    dataView.setUint32(4, upper32bits, true);
-  };
-
-  this.isNull = function() {
-    return this.getOffsetAndKind() === 0 && this.getUpper32Bits() === 0;
-  };
-
-  this.clear = function() {
-    this.setOffsetAndKind(0);
-    this.setUpper32Bits(0);
-  };
-
-  this.kind = function() {
-    return this.getOffsetAndKind() & 3;
-  };
-
-  this.target = function() {
-    var offset = this.getOffsetAndKind() >> 2;
-    return (baseOffset >>> 3) + 1 + offset;
-  };
-
-  this.setKindAndTarget = function(kind, target, segment) {
-    var relOffset = target - (baseOffset >>> 3) - 1;
-    this.setOffsetAndKind((relOffset << 2) | kind);
-  };
-
-  this.setKindAndTargetForEmptyStruct = function() {
-    this.setOffsetAndKind(0xfffffffc);
-  };
-
-  this.setKindForOrphan = function(kind) {
-    kj.debug.DREQUIRE(kind !== capnp.layout.Kind.FAR);
-    this.setOffsetAndKind(kind | 0xfffffffc);
-  };
-
-  this.setListRefInlineComposite = function(wordCount) {
-    this.setUpper32Bits((wordCount << 3) | capnp.layout.FieldSize.INLINE_COMPOSITE);
-  };
-
-  this.setKindAndInlineCompositeListElementCount = function(kind, elementCount) {
-    this.setOffsetAndKind((elementCount << 2) | kind);
-  };
-
-  this.setStructRef = function(structSize) {
-    goog.asserts.assert(structSize instanceof capnp.layout.StructSize);
-    //this.setUpper32Bits(structSize.getDataWordCount() << 16 | structSize.getPointerCount());
-    dataView.setUint16(4, structSize.getDataWordCount(), true);
-    dataView.setUint16(6, structSize.getPointerCount(), true);
-  };
-
-  this.setFar = function(isDoubleFar, pos) {
-    this.setOffsetAndKind((pos << 3) | (isDoubleFar << 2) | capnp.layout.Kind.FAR);
-  };
-
-  this.setFarRef = function(segmentId) {
-    this.setUpper32Bits(segmentId);
-  };
-
-  this.farRef = function() {
-    return { segmentId: this.getUpper32Bits() };
-  };
-
-  this.farPositionInSegment = function() {
-    kj.debug.DREQUIRE(this.kind() === capnp.layout.Kind.FAR,
-                      'positionInSegment() should only be called on FAR pointers.');
-    return this.getOffsetAndKind() >>> 3;
-  };
-
-  this.isDoubleFar = function() {
-    kj.debug.DREQUIRE(this.kind() === capnp.layout.Kind.FAR,
-                      'isDoubleFar() should only be called on FAR pointers.');
-    return (this.getOffsetAndKind() >> 2) & 1;
-  };
-
-  this.getStructRef = function() {
-    var dataSize = dataView.getUint16(4, true);
-    var ptrCount = dataView.getUint16(6, true);
-    return new capnp.layout.StructRef(dataSize, ptrCount);
-  };
-
-  this.setListRef = function(fieldSize, elementCount) {
-    this.setUpper32Bits((elementCount << 3) | fieldSize);
-  };
-
-  this.getListRef = function() {
-    var upper32Bits = this.getUpper32Bits();
-    return new capnp.layout.ListRef(upper32Bits & 7, upper32Bits >> 3);
-  };
-
-  this.inlineCompositeListElementCount = function() {
-    return this.getOffsetAndKind() >>> 2;
-  };
-
-  this.toString = function() {
-    return 'WirePointer{byteOffset=' + baseOffset + ', kind=' + this.kind() + ', data=' + kj.util.decimalToHex(this.getOffsetAndKind(), 8) + ' ' + kj.util.decimalToHex(this.getUpper32Bits(), 8) + '}';
-  };
-
-  return this;
+  this.baseOffset = baseOffset;
+  this.dataView = dataView;
+};
+
+capnp.layout.WirePointer.prototype.getByteOffset = function() {
+  return this.baseOffset;
+};
+
+capnp.layout.WirePointer.prototype.asPointer = function() {
+  return this.baseOffset >> 3;
+};
+
+capnp.layout.WirePointer.prototype.getOffsetAndKind = function() {
+  return this.dataView.getUint32(this.baseOffset, true);
+};
+
+capnp.layout.WirePointer.prototype.setOffsetAndKind = function(offsetAndKind) {
+  this.dataView.setUint32(this.baseOffset, offsetAndKind, true);
+};
+
+capnp.layout.WirePointer.prototype.setKindWithZeroOffset = function(kind) {
+  this.setOffsetAndKind(kind);
+};
+
+capnp.layout.WirePointer.prototype.getUpper32Bits = function() {
+  return this.dataView.getUint32(this.baseOffset + 4, true);
+};
+
+capnp.layout.WirePointer.prototype.setUpper32Bits = function(upper32bits) {
+  this.dataView.setUint32(this.baseOffset + 4, upper32bits, true);
+};
+
+capnp.layout.WirePointer.prototype.isNull = function() {
+  return this.getOffsetAndKind() === 0 && this.getUpper32Bits() === 0;
+};
+
+capnp.layout.WirePointer.prototype.clear = function() {
+  this.setOffsetAndKind(0);
+  this.setUpper32Bits(0);
+};
+
+capnp.layout.WirePointer.prototype.kind = function() {
+  return this.getOffsetAndKind() & 3;
+};
+
+capnp.layout.WirePointer.prototype.target = function() {
+  var offset = this.getOffsetAndKind() >> 2;
+  return (this.baseOffset >>> 3) + 1 + offset;
+};
+
+capnp.layout.WirePointer.prototype.setKindAndTarget = function(kind, target, segment) {
+  var relOffset = target - (this.baseOffset >>> 3) - 1;
+  this.setOffsetAndKind((relOffset << 2) | kind);
+};
+
+capnp.layout.WirePointer.prototype.setKindAndTargetForEmptyStruct = function() {
+  this.setOffsetAndKind(0xfffffffc);
+};
+
+capnp.layout.WirePointer.prototype.setKindForOrphan = function(kind) {
+  kj.debug.DREQUIRE(kind !== capnp.layout.Kind.FAR);
+  this.setOffsetAndKind(kind | 0xfffffffc);
+};
+
+capnp.layout.WirePointer.prototype.setListRefInlineComposite = function(wordCount) {
+  this.setUpper32Bits((wordCount << 3) | capnp.layout.FieldSize.INLINE_COMPOSITE);
+};
+
+capnp.layout.WirePointer.prototype.setKindAndInlineCompositeListElementCount = function(kind, elementCount) {
+  this.setOffsetAndKind((elementCount << 2) | kind);
+};
+
+capnp.layout.WirePointer.prototype.setStructRef = function(structSize) {
+  goog.asserts.assert(structSize instanceof capnp.layout.StructSize);
+  //this.setUpper32Bits(structSize.getDataWordCount() << 16 | structSize.getPointerCount());
+  this.dataView.setUint16(this.baseOffset + 4, structSize.getDataWordCount(), true);
+  this.dataView.setUint16(this.baseOffset + 6, structSize.getPointerCount(), true);
+};
+
+capnp.layout.WirePointer.prototype.setFar = function(isDoubleFar, pos) {
+  this.setOffsetAndKind((pos << 3) | (isDoubleFar << 2) | capnp.layout.Kind.FAR);
+};
+
+capnp.layout.WirePointer.prototype.setFarRef = function(segmentId) {
+  this.setUpper32Bits(segmentId);
+};
+
+capnp.layout.WirePointer.prototype.farRef = function() {
+  return { segmentId: this.getUpper32Bits() };
+};
+
+capnp.layout.WirePointer.prototype.farPositionInSegment = function() {
+  kj.debug.DREQUIRE(this.kind() === capnp.layout.Kind.FAR,
+                    'positionInSegment() should only be called on FAR pointers.');
+  return this.getOffsetAndKind() >>> 3;
+};
+
+capnp.layout.WirePointer.prototype.isDoubleFar = function() {
+  kj.debug.DREQUIRE(this.kind() === capnp.layout.Kind.FAR,
+                    'isDoubleFar() should only be called on FAR pointers.');
+  return (this.getOffsetAndKind() >> 2) & 1;
+};
+
+capnp.layout.WirePointer.prototype.getStructRef = function() {
+  var dataSize = this.dataView.getUint16(this.baseOffset + 4, true);
+  var ptrCount = this.dataView.getUint16(this.baseOffset + 6, true);
+  return new capnp.layout.StructRef(dataSize, ptrCount);
+};
+
+capnp.layout.WirePointer.prototype.setListRef = function(fieldSize, elementCount) {
+  this.setUpper32Bits((elementCount << 3) | fieldSize);
+};
+
+capnp.layout.WirePointer.prototype.getListRef = function() {
+  var upper32Bits = this.getUpper32Bits();
+  return new capnp.layout.ListRef(upper32Bits & 7, upper32Bits >> 3);
+};
+
+capnp.layout.WirePointer.prototype.inlineCompositeListElementCount = function() {
+  return this.getOffsetAndKind() >>> 2;
+};
+
+capnp.layout.WirePointer.prototype.toString = function() {
+  return 'WirePointer{byteOffset=' + this.baseOffset + ', kind=' + this.kind() + ', data=' + kj.util.decimalToHex(this.getOffsetAndKind(), 8) + ' ' + kj.util.decimalToHex(this.getUpper32Bits(), 8) + '}';
 };
 
 capnp.layout.WirePointer.zero = function() {
@@ -600,11 +609,10 @@ capnp.layout.initStructListPointer = function(ref, segment, elementCount, elemen
 
   // Allocate the list, prefixed by a single WirePointer.
   var wordCount = elementCount * wordsPerElement;
-  var allocateResult = capnp.layout.allocate(ref, segment, capnp.common.POINTER_SIZE_IN_WORDS + wordCount, capnp.layout.Kind.LIST,
-                                             orphanArena);
-  var ptr = allocateResult[0];
-  segment = allocateResult[1];
-  ref = allocateResult[2];
+  var ptr = capnp.layout.allocate(ref, segment, capnp.common.POINTER_SIZE_IN_WORDS + wordCount, capnp.layout.Kind.LIST,
+                                  orphanArena);
+  segment = allocatedSegment;
+  ref = allocatedRef;
 
   // Initialize the pointer.
   // INLINE_COMPOSITE lists replace the element count with the word count.
@@ -630,97 +638,113 @@ capnp.layout.ListBuilder = function(segment, ptr, step, elementCount, structData
   goog.asserts.assert(!isNaN(step));
 
   this.segment = segment;
+  this.ptr = ptr;
+  this.step = step;
+  this.elementCount = elementCount;
+  this.structDataSize = structDataSize;
+  this.structPointerCount = structPointerCount;
+};
 
-  this.toString = function() { return 'ListBuilder{ptr=' + ptr + ',step=' + step + ',elementCount=' + elementCount + '}'; };
-
-  this.asReader = function() {
-    return new capnp.layout.ListReader(segment, ptr, elementCount, step, structDataSize, structPointerCount, Number.MAX_VALUE);
-  };
+capnp.layout.ListBuilder.prototype.toString = function() { return 'ListBuilder{ptr=' + this.ptr + ',step=' + this.step + ',elementCount=' + this.elementCount + '}'; };
 
-  this.size = function() { return elementCount; };
+capnp.layout.ListBuilder.prototype.asReader = function() {
+  return new capnp.layout.ListReader(this.segment, this.ptr, this.elementCount, this.step, this.structDataSize, this.structPointerCount, Number.MAX_VALUE);
+};
 
+capnp.layout.ListBuilder.prototype.size = function() { return this.elementCount; };
 
-  this.getLocation = function() {
-    // Get the object's location.  Only valid for independently-allocated objects (i.e. not list
-    // elements).
+capnp.layout.ListBuilder.prototype.getLocation = function() {
+  // Get the object's location.  Only valid for independently-allocated objects (i.e. not list
+  // elements).
 
-    if (step <= capnp.common.BITS_PER_WORD) {
-      return ptr;
-    } else {
-      return ptr - capnp.common.POINTER_SIZE_IN_WORDS;
-    }
+  if (this.step <= capnp.common.BITS_PER_WORD) {
+    return this.ptr;
+  } else {
+    return this.ptr - capnp.common.POINTER_SIZE_IN_WORDS;
   }
+};
 
-  this.getStructElement = function(index) {
+capnp.layout.ListBuilder.prototype.getStructElement = function(index) {
 
-    var indexBit = index * step;
-    var structData = (ptr << 3) + (indexBit / capnp.common.BITS_PER_BYTE) >>> 0;
+  var indexBit = index * this.step;
+  var structData = (this.ptr << 3) + (indexBit / capnp.common.BITS_PER_BYTE) >>> 0;
 
-    return new capnp.layout.StructBuilder(segment,
-                                          structData,
-                                          (structData + (structDataSize / capnp.common.BITS_PER_BYTE) >>> 0) >> 3,
-                                          structDataSize,
-                                          structPointerCount,
-                                          indexBit % capnp.common.BITS_PER_BYTE);
-  };
+  return new capnp.layout.StructBuilder(this.segment,
+                                        structData,
+                                        (structData + (this.structDataSize / capnp.common.BITS_PER_BYTE) >>> 0) >> 3,
+                                        this.structDataSize,
+                                        this.structPointerCount,
+                                        indexBit % capnp.common.BITS_PER_BYTE);
+};
+
+/**
+ *  Moves `builder', a StructBuilder previously obtained from
+ *  getStructElement() on this list, to element `index' and returns it.
+ */
+capnp.layout.ListBuilder.prototype.moveToStructElement = function(builder, index) {
+
+  var indexBit = index * this.step;
+  var structData = (this.ptr << 3) + (indexBit / capnp.common.BITS_PER_BYTE) >>> 0;
+
+  builder.data = structData;
+  builder.pointers = (structData + (this.structDataSize / capnp.common.BITS_PER_BYTE) >>> 0) >> 3;
+  builder.bit0Offset = indexBit % capnp.common.BITS_PER_BYTE;
+  return builder;
+};
 
-  this.getTextBlobElement = function(index) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    return capnp.layout.getWritableTextPointer(ref, ref.target(), segment, '', 0);
-  };
+capnp.layout.ListBuilder.prototype._getPointerElement = function(index) {
+  return this.segment.createWirePointerAt((this.ptr << 3) + index * this.step / capnp.common.BITS_PER_BYTE);
+};
 
-  this.getDataBlobElement = function(index) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    return capnp.layout.getWritableDataPointer(ref, ref.target(), segment, null, 0);
-  };
+capnp.layout.ListBuilder.prototype.getTextBlobElement = function(index) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.getWritableTextPointer(ref, ref.target(), this.segment, '', 0);
+};
 
-  this.setTextBlobElement = function(index, value) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    capnp.layout.setTextPointer(ref, segment, value);
-  };
+capnp.layout.ListBuilder.prototype.getDataBlobElement = function(index) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.getWritableDataPointer(ref, ref.target(), this.segment, null, 0);
+};
 
-  this.setDataBlobElement = function(index, value) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    capnp.layout.setDataPointer(ref, segment, value);
-  };
+capnp.layout.ListBuilder.prototype.setTextBlobElement = function(index, value) {
+  capnp.layout.setTextPointer(this._getPointerElement(index), this.segment, value);
+};
 
-  this.getListElement = function(index, expectedElementSize) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    return capnp.layout.getWritableListPointer(ref, ref.target(), segment, expectedElementSize, null);
-  };
+capnp.layout.ListBuilder.prototype.setDataBlobElement = function(index, value) {
+  capnp.layout.setDataPointer(this._getPointerElement(index), this.segment, value);
+};
 
-  this.setListElement = function(index, value) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    capnp.layout.setListPointer(segment, ref, value);
-  };
+capnp.layout.ListBuilder.prototype.getListElement = function(index, expectedElementSize) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.getWritableListPointer(ref, ref.target(), this.segment, expectedElementSize, null);
+};
 
-  this.initListElement = function(index, elementSize, elementCount) {
-    goog.asserts.assert(elementSize !== undefined);
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    return capnp.layout.initListPointer(ref, segment, elementCount, elementSize);
-  };
+capnp.layout.ListBuilder.prototype.setListElement = function(index, value) {
+  capnp.layout.setListPointer(this.segment, this._getPointerElement(index), value);
+};
 
-  this.getStructListElement = function(index, elementSize) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    return capnp.layout.getWritableStructListPointer(ref, ref.target(), segment, elementSize, null);
-  };
+capnp.layout.ListBuilder.prototype.initListElement = function(index, elementSize, elementCount) {
+  goog.asserts.assert(elementSize !== undefined);
+  return capnp.layout.initListPointer(this._getPointerElement(index), this.segment, elementCount, elementSize);
+};
 
-  this.initStructListElement = function(index, elementCount, elementSize) {
-    var ref = segment.createWirePointerAt((ptr << 3) + index * step / capnp.common.BITS_PER_BYTE);
-    return capnp.layout.initStructListPointer(ref, segment, elementCount, elementSize);
-  };
+capnp.layout.ListBuilder.prototype.getStructListElement = function(index, elementSize) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.getWritableStructListPointer(ref, ref.target(), this.segment, elementSize, null);
+};
 
-  this.getDataElement = function(clazz, index) {
-    var offset = (ptr * capnp.common.BITS_PER_WORD) + index * step;
-    return clazz.getValue(segment.getDataView(), offset);
-  };
+capnp.layout.ListBuilder.prototype.initStructListElement = function(index, elementCount, elementSize) {
+  return capnp.layout.initStructListPointer(this._getPointerElement(index), this.segment, elementCount, elementSize);
+};
 
-  this.setDataElement = function(clazz, index, value) {
-    var offset = (ptr * capnp.common.BITS_PER_WORD) + index * step;
-    clazz.setValue(segment.getDataView(), offset, value);
-  };
+capnp.layout.ListBuilder.prototype.getDataElement = function(clazz, index) {
+  var offset = (this.ptr * capnp.common.BITS_PER_WORD) + index * this.step;
+  return clazz.getValue(this.segment.getDataView(), offset);
+};
 
-  return this;
+capnp.layout.ListBuilder.prototype.setDataElement = function(clazz, index, value) {
+  var offset = (this.ptr * capnp.common.BITS_PER_WORD) + index * this.step;
+  clazz.setValue(this.segment.getDataView(), offset, value);
 };
 
 
@@ -738,45 +762,65 @@ capnp.layout.ListReader = function(segment, ptr, elementCount, step, structDataS
   this.structDataSize = structDataSize;
   this.structPointerCount = structPointerCount;
   this.nestingLimit = nestingLimit;
+};
+
+capnp.layout.ListReader.prototype.getSegment = function() { return this.segment; };
+capnp.layout.ListReader.prototype.size = function() { return this.elementCount; };
 
-  this.getSegment = function() { return segment; };
-  this.size = function() { return elementCount; };
+capnp.layout.ListReader.prototype.getDataElement = function(clazz, index) {
+  var offset = (this.ptr * capnp.common.BITS_PER_WORD) + index * this.step;
+  return clazz.getValue(this.segment.getDataView(), offset);
+};
 
-  this.getDataElement = function(clazz, index) {
-    var offset = (ptr * capnp.common.BITS_PER_WORD) + index * step;
-    return clazz.getValue(segment.getDataView(), offset);
-  };
+capnp.layout.ListReader.prototype.getStructElement = function(index) {
 
-  this.getStructElement = function(index) {
+  var indexBit = index * this.step;
+  var structData = (this.ptr << 3) + ((indexBit / capnp.common.BITS_PER_BYTE) >>> 0);
 
-    var indexBit = index * step;
-    var structData = (ptr << 3) + ((indexBit / capnp.common.BITS_PER_BYTE) >>> 0);
+  return new capnp.layout.StructReader(this.segment, structData,
+                                       (structData >> 3) + (this.structDataSize / capnp.common.BITS_PER_WORD),
+                                       this.structDataSize, this.structPointerCount, indexBit % capnp.common.BITS_PER_BYTE,
+                                       this.nestingLimit - 1);
+};
 
-    return new capnp.layout.StructReader(segment, structData,
-                                         (structData >> 3) + (structDataSize / capnp.common.BITS_PER_WORD),
-                                         structDataSize, structPointerCount, indexBit % capnp.common.BITS_PER_BYTE,
-                                         nestingLimit - 1);
-  };
+/**
+ *  Moves `reader', a StructReader previously obtained from
+ *  getStructElement() on this list, to element `index' and returns it.
+ *  Used to walk struct lists without allocating a reader per element.
+ */
+capnp.layout.ListReader.prototype.moveToStructElement = function(reader, index) {
+
+  var indexBit = index * this.step;
+  var structData = (this.ptr << 3) + ((indexBit / capnp.common.BITS_PER_BYTE) >>> 0);
+
+  reader.data = structData;
+  reader.pointers = (structData >> 3) + (this.structDataSize / capnp.common.BITS_PER_WORD);
+  reader.bit0Offset = indexBit % capnp.common.BITS_PER_BYTE;
+  return reader;
+};
 
-  this.getListElement = function(index, expectedElementSize) {
-    var ref = checkAlignment(segment, (ptr << 3) + (index * step / capnp.common.BITS_PER_BYTE) >>> 0);
-    return capnp.layout.readListPointer(
-      segment, ref, ref.target(), null, expectedElementSize, nestingLimit);
-  };
+capnp.layout.ListReader.prototype._getPointerElement = function(index) {
+  return checkAlignment(this.segment, (this.ptr << 3) + (index * this.step / capnp.common.BITS_PER_BYTE) >>> 0);
+};
 
-  this.getTextBlobElement = function(index) {
-    var ref = checkAlignment(segment, (ptr << 3) + (index * step / capnp.common.BITS_PER_BYTE) >>> 0);
-    return capnp.layout.readTextPointer(segment, ref, ref.target(), '', 0);
-  };
+capnp.layout.ListReader.prototype.getListElement = function(index, expectedElementSize) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.readListPointer(
+    this.segment, ref, ref.target(), null, expectedElementSize, this.nestingLimit);
+};
 
-  this.getDataBlobElement = function(index) {
-    var ref = checkAlignment(segment, (ptr << 3) + (index * step / capnp.common.BITS_PER_BYTE) >>> 0);
-    return capnp.layout.readDataPointer(segment, ref, ref.target(), null, 0);
-  };
+capnp.layout.ListReader.prototype.getTextBlobElement = function(index) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.readTextPointer(this.segment, ref, ref.target(), '', 0);
+};
 
-  this.toString = function() { return 'ListReader{...}'; };
+capnp.layout.ListReader.prototype.getDataBlobElement = function(index) {
+  var ref = this._getPointerElement(index);
+  return capnp.layout.readDataPointer(this.segment, ref, ref.target(), null, 0);
 };
 
+capnp.layout.ListReader.prototype.toString = function() { return 'ListReader{...}'; };
+
 capnp.layout.ListReader.readRoot = function(location, segment, elementSize) {
 
   goog.asserts.assert(segment instanceof capnp.arena.SegmentReader, 'ListReader.readRoot got invalid segment');
@@ -787,10 +831,22 @@ capnp.layout.ListReader.readRoot = function(location, segment, elementSize) {
 };
 
 capnp.layout.setTextPointer = function(ref, segment, value, orphanArena) {
-  var allocation = capnp.layout.initTextPointer(ref, segment, value.size(), orphanArena);
+  var allocation;
 
-  var target = allocation.value.asUint8Array();
-  target.set(value.asUint8Array());
+  // Strings are encoded straight into the allocated space, without going
+  // through an intermediate byte array.
+  if (kj.util.isString(value)) {
+    allocation = capnp.layout.initTextPointer(ref, segment, capnp.blob.utf8Length(value), orphanArena);
+    capnp.blob.encodeUtf8Into(value, allocation.value.asUint8Array());
+  }
+  else if (value instanceof capnp.blob.StringTextReader) {
+    allocation = capnp.layout.initTextPointer(ref, segment, value.size(), orphanArena);
+    capnp.blob.encodeUtf8Into(value.str(), allocation.value.asUint8Array());
+  }
+  else {
+    allocation = capnp.layout.initTextPointer(ref, segment, value.size(), orphanArena);
+    allocation.value.asUint8Array().set(value.asUint8Array());
+  }
 
   return allocation;
 };
@@ -802,16 +858,15 @@ capnp.layout.initTextPointer = function(ref, segment, size, orphanArena) {
   var byteSize = size + 1;
 
   // Allocate the space.
-  var allocateResult = capnp.layout.allocate(ref, segment, capnp.common.roundBytesUpToWords(byteSize), capnp.layout.Kind.LIST, orphanArena);
-  var ptr = allocateResult[0];
-  segment = allocateResult[1];
-  ref = allocateResult[2];
+  var ptr = capnp.layout.allocate(ref, segment, capnp.common.roundBytesUpToWords(byteSize), capnp.layout.Kind.LIST, orphanArena);
+  segment = allocatedSegment;
+  ref = allocatedRef;
 
   // Initialize the pointer.
   ref.setListRef(capnp.layout.FieldSize.BYTE, byteSize);
 
   // Build the Text::Builder.  This will initialize the NUL terminator.
-  return { segment: segment, value: capnp.blob.Text.Builder(segment, ptr, size) };
+  return { segment: segment, value: new capnp.blob.Text.Builder(segment, ptr, size) };
 };
 
 
@@ -826,9 +881,16 @@ capnp.layout.pointersPerElement = function(fieldSize) {
 };
 
 
+// Out values of `capnp.layout.allocate()`, read back by the caller right after the call the same
+// way `arena.allocatedWords` is, so that allocation doesn't create a result array per object.
+var allocatedSegment = null;
+var allocatedRef = null;
+
 capnp.layout.allocate = function(ref, segment, amount, kind, orphanArena) {
 
-  // Allocate space in the message for a new object, creating far pointers if necessary.
+  // Allocate space in the message for a new object, creating far pointers if necessary.  Returns
+  // the word offset of the new object; the updated `segment` and `ref` described below are left
+  // in `allocatedSegment` and `allocatedRef`.
   //
   // * `ref` starts out being a reference to the pointer which shall be assigned to point at the
   //   new object.  On return, `ref` points to a pointer which needs to be initialized with
@@ -861,7 +923,9 @@ capnp.layout.allocate = function(ref, segment, amount, kind, orphanArena) {
       // Note that the check for kind == WirePointer::STRUCT will hopefully cause this whole
       // branch to be optimized away from all the call sites that are allocating non-structs.
       ref.setKindAndTargetForEmptyStruct();
-      return [ref.asPointer(), segment, ref];
+      allocatedSegment = segment;
+      allocatedRef = ref;
+      return ref.asPointer();
     }
 
     var ptr = segment.allocate(amount);
@@ -871,9 +935,9 @@ capnp.layout.allocate = function(ref, segment, amount, kind, orphanArena) {
       // space to act as the landing pad for a far pointer.
 
       var amountPlusRef = amount + capnp.common.POINTER_SIZE_IN_WORDS;
-      var allocation = segment.getArena().allocate(amountPlusRef);
-      segment = allocation.segment;
-      ptr = allocation.words;
+      var arena = segment.getArena();
+      segment = arena.allocate(amountPlusRef);
+      ptr = arena.allocatedWords;
 
       goog.asserts.assert(kj.util.isRegularNumber(ptr));
 
@@ -886,29 +950,36 @@ capnp.layout.allocate = function(ref, segment, amount, kind, orphanArena) {
       ref.setKindAndTarget(kind, ptr + capnp.common.POINTER_SIZE_IN_WORDS, segment);
 
       // Allocated space follows new pointer.
-      return [ptr + capnp.common.POINTER_SIZE_IN_WORDS, segment, ref];
+      allocatedSegment = segment;
+      allocatedRef = ref;
+      return ptr + capnp.common.POINTER_SIZE_IN_WORDS;
     }
     else {
       goog.asserts.assert(kj.util.isRegularNumber(ptr));
       ref.setKindAndTarget(kind, ptr, segment);
-      return [ptr, segment, ref];
+      allocatedSegment = segment;
+      allocatedRef = ref;
+      return ptr;
     }
   }
   else {
     // orphanArena is non-null.  Allocate an orphan.
     kj.debug.DASSERT(ref.isNull());
-    var allocation = orphanArena.allocate(amount);
-    segment = allocation.segment;
+    segment = orphanArena.allocate(amount);
     ref.setKindForOrphan(kind);
-    return [allocation.words, segment, ref];
+    allocatedSegment = segment;
+    allocatedRef = ref;
+    return orphanArena.allocatedWords;
   }
 };
 
 capnp.layout.setDataPointer = function(ref, segment, value, orphanArena) {
 
-  var allocation = capnp.layout.initDataPointer(ref, segment, value.size(), orphanArena);
+  // Plain byte arrays are copied in directly, without wrapping them in a Data reader first.
+  var isBytes = value instanceof Uint8Array;
+  var allocation = capnp.layout.initDataPointer(ref, segment, isBytes ? value.length : value.size(), orphanArena);
   var target = allocation.value.asUint8Array();
-  target.set(value.asUint8Array());
+  target.set(isBytes ? value : value.asUint8Array());
   return allocation;
 };
 
@@ -916,10 +987,9 @@ capnp.layout.setDataPointer = function(ref, segment, value, orphanArena) {
 capnp.layout.initDataPointer = function(ref, segment, size, orphanArena) {
 
   // Allocate the space.
-  var allocateResult = capnp.layout.allocate(ref, segment, capnp.common.roundBytesUpToWords(size), capnp.layout.Kind.LIST, orphanArena);
-  var ptr = allocateResult[0];
-  segment = allocateResult[1];
-  ref = allocateResult[2];
+  var ptr = capnp.layout.allocate(ref, segment, capnp.common.roundBytesUpToWords(size), capnp.layout.Kind.LIST, orphanArena);
+  segment = allocatedSegment;
+  ref = allocatedRef;
 
   // Initialize the pointer.
   ref.setListRef(capnp.layout.FieldSize.BYTE, size);
@@ -931,10 +1001,9 @@ capnp.layout.initDataPointer = function(ref, segment, size, orphanArena) {
 capnp.layout.initStructPointer = function(ref, segment, size, orphanArena) {
 
   // Allocate space for the new struct.  Newly-allocated space is automatically zeroed.
-  var allocateResult = capnp.layout.allocate(ref, segment, size.getTotal(), capnp.layout.Kind.STRUCT, orphanArena);
-  var ptr = allocateResult[0];
-  segment = allocateResult[1];
-  ref = allocateResult[2];
+  var ptr = capnp.layout.allocate(ref, segment, size.getTotal(), capnp.layout.Kind.STRUCT, orphanArena);
+  segment = allocatedSegment;
+  ref = allocatedRef;
 
   // Initialize the pointer.
   ref.setStructRef(size);
@@ -1368,6 +1437,69 @@ capnp.layout.StructBase.prototype.setDataField_uint64_masked = function(offset,
   capnp.prim.uint64_t.setValue(this.seg_dataView, (this.data + (offset >>> 0) * 8) * capnp.common.BITS_PER_BYTE, [value[0] ^ mask[0], value[1] ^ mask[1]]);
 };
 
+/**
+ *  @param {number} offset
+ *  @return {bigint}
+ */
+capnp.layout.StructBase.prototype.getDataField_bigint64 = function(offset) {
+  if (offset * 64 < this.dataSize) {
+    return this.seg_dataView.getBigInt64(this.data + offset * 8, true);
+  }
+  else {
+    return BigInt(0);
+  }
+};
+
+/**
+ *  @param {number} offset
+ *  @param {bigint} mask
+ *  @return {bigint}
+ */
+capnp.layout.StructBase.prototype.getDataField_bigint64_masked = function(offset, mask) {
+  return this.getDataField_bigint64(offset) ^ mask;
+};
+
+capnp.layout.StructBase.prototype.setDataField_bigint64 = function(offset, value) {
+  this.seg_dataView.setBigInt64(this.data + offset * 8, BigInt(value), true);
+};
+
+capnp.layout.StructBase.prototype.setDataField_bigint64_masked = function(offset, value, mask) {
+  this.seg_dataView.setBigInt64(this.data + offset * 8, BigInt(value) ^ mask, true);
+};
+
+/**
+ *  @param {number} offset
+ *  @return {bigint}
+ */
+capnp.layout.StructBase.prototype.getDataField_biguint64 = function(offset) {
+  if (offset * 64 < this.dataSize) {
+    return this.seg_dataView.getBigUint64(this.data + offset * 8, true);
+  }
+  else {
+    return BigInt(0);
+  }
+};
+
+/**
+ *  @param {number} offset
+ *  @param {bigint} mask
+ *  @return {bigint}
+ */
+capnp.layout.StructBase.prototype.getDataField_biguint64_masked = function(offset, mask) {
+  return this.getDataField_biguint64(offset) ^ mask;
+};
+
+capnp.layout.StructBase.prototype.setDataField_biguint64 = function(offset, value) {
+  this.seg_dataView.setBigUint64(this.data + offset * 8, BigInt(value), true);
+};
+
+capnp.layout.StructBase.prototype.setDataField_biguint64_masked = function(offset, value, mask) {
+  this.seg_dataView.setBigUint64(this.data + offset * 8, BigInt(value) ^ mask, true);
+};
+
+capnp.layout.StructBase.prototype.hasDataField_bigint64 = capnp.layout.StructBase.prototype.hasDataField_int64;
+capnp.layout.StructBase.prototype.hasDataField_biguint64 = capnp.layout.StructBase.prototype.hasDataField_uint64;
+
 
 capnp.layout.StructBase.prototype.setDataField_float32 = function(offset, value) {
   capnp.prim.float32_t.setValue(this.seg_dataView, (this.data + offset * 4) * capnp.common.BITS_PER_BYTE, value);
@@ -1377,6 +1509,17 @@ capnp.layout.StructBase.prototype.setDataField_float64 = function(offset, value)
   capnp.prim.float64_t.setValue(this.seg_dataView, (this.data + offset * 8) * capnp.common.BITS_PER_BYTE, value);
 };
 
+capnp.layout.StructBase.prototype.setDataField_float32_masked = function(offset, value, mask) {
+  converter.setFloat32(0, value, true);
+  this.seg_dataView.setUint32(this.data + offset * 4, converter.getUint32(0, true) ^ mask, true);
+};
+
+capnp.layout.StructBase.prototype.setDataField_float64_masked = function(offset, value, mask) {
+  converter.setFloat64(0, value, true);
+  this.seg_dataView.setUint32(this.data + offset * 8, converter.getUint32(0, true) ^ mask[1], true);
+  this.seg_dataView.setUint32(this.data + offset * 8 + 4, converter.getUint32(4, true) ^ mask[0], true);
+};
+
 
 capnp.layout.StructBase.prototype.setDataField_bool = function(offset, value) {
   offset += this.bit0Offset;
@@ -1403,123 +1546,115 @@ capnp.layout.StructBuilder = function(segment, data, pointerOffset, dataSize, po
 
   capnp.layout.StructBase.call(this, segment, data, dataSize, bit0Offset);
 
-  goog.asserts.assert(typeof(pointerOffset) === 'number', 'invalid pointerOffset');
-
-  this.getLocation = function() { return data >> 3; }
-
-  this.getBit0Offset = function() { return bit0Offset; };
-
-  this.getSegmentBuilder = function() { return segment; };
-  this.getPointerOffset = function() { return pointerOffset; };
-  this.toString = function() { return 'StructBuilder(...)'; };
-
-  this.setTextBlobField = function(ptrIndex, value) {
-    capnp.layout.setTextPointer(segment.createWirePointerAt((pointerOffset + ptrIndex) * capnp.common.BYTES_PER_WORD), segment, value);
-  };
-
-  this.setDataBlobField = function(ptrIndex, value) {
-    capnp.layout.setDataPointer(segment.createWirePointerAt((pointerOffset + ptrIndex) * capnp.common.BYTES_PER_WORD), segment, value);
-  };
-
-  this.getTextBlobField = function(ptrIndex, defaultValue, defaultSize) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.getWritableTextPointer(ref, ref.target(), segment, defaultValue, defaultSize);
-  };
-
-  this.disownTextBlobField = function(ptrIndex) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.disown(segment, ref);
-  };
-
-  this.disownDataBlobField = function(ptrIndex) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.disown(segment, ref);
-  };
-
-  this.getDataBlobField = function(ptrIndex, defaultValue, defaultSize) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.getWritableDataPointer(ref, ref.target(), segment, defaultValue, defaultSize);
-  };
-
-  this.getStructField = function(ptrIndex, size, defaultValue) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.getWritableStructPointer(ref, ref.target(), segment, size, defaultValue);
-  };
-
-  this.initStructField = function(ptrIndex, size) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.initStructPointer(ref, segment, size);
-  };
-
-  this.isPointerFieldNull = function(ptrIndex) {
-    var dataView = segment.getDataView();
-    return dataView.getUint32((pointerOffset + ptrIndex) * capnp.common.BYTES_PER_WORD) === 0
-      && dataView.getUint32((pointerOffset + ptrIndex) * capnp.common.BYTES_PER_WORD + 4) === 0;
-  };
-
-  this.getListField = function(ptrIndex, elementSize, defaultValue) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.getWritableListPointer(ref, ref.target(), segment, elementSize, defaultValue);
-  };
-
-  this.getStructListField = function(ptrIndex, elementSize, defaultValue) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.getWritableStructListPointer(ref, ref.target(), segment, elementSize, defaultValue);
-  };
-
-  this.initStructListField = function(ptrIndex, elementCount, elementSize) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.initStructListPointer(ref, segment, elementCount, elementSize);
-  };
-
-  this.setListField = function(ptrIndex, value) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    capnp.layout.setListPointer(segment, ref, value);
-  };
-
-  this.initListField = function(ptrIndex, elementSize, elementCount) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.initListPointer(ref, segment, elementCount, elementSize);
-  };
-
-  this.disownListField = function(ptrIndex) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.disown(segment, ref);
-  };
-
-  this.clearPointerField = function(ptrIndex) {
-    var dataView = segment.getDataView();
-    dataView.setUint32((pointerOffset + ptrIndex) * capnp.common.BYTES_PER_WORD, 0);
-    dataView.setUint32((pointerOffset + ptrIndex) * capnp.common.BYTES_PER_WORD + 4, 0);
-  };
-
-  this.setStructField = function(ptrIndex, value) {
-    goog.asserts.assert(value instanceof capnp.layout.StructReader, 'not a StructReader: ' + value);
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    capnp.layout.setStructPointer(segment, ref, value);
-  };
-
-  this.disownStructField = function(ptrIndex) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.disown(segment, ref);
-  };
-
-  this.adoptStructField = function(ptrIndex, value) {
-    var ref = segment.createWirePointerAt((pointerOffset + ptrIndex) << 3);
-    return capnp.layout.adopt(segment, ref, value);
-  };
-
-  this.asReader = function() {
-    return new capnp.layout.StructReader(segment, data, pointerOffset, dataSize, pointerCount, bit0Offset, Number.MAX_VALUE);
-  };
-
-  this.toString = function() { return 'StructBuilder{segment=' + segment.toString() + ',data=' + data + ', pointerOffset=' + pointerOffset + '}'; };
-
-  return this;
+  this.pointers = pointerOffset;
+  this.pointerCount = pointerCount;
 };
 capnp.layout.StructBuilder.prototype = Object.create(capnp.layout.StructBase.prototype);
 capnp.layout.StructBuilder.prototype.constructor = capnp.layout.StructBuilder;
 
+capnp.layout.StructBuilder.prototype.getLocation = function() { return this.data >> 3; };
+
+capnp.layout.StructBuilder.prototype.getBit0Offset = function() { return this.bit0Offset; };
+
+capnp.layout.StructBuilder.prototype.getSegmentBuilder = function() { return this.segment; };
+capnp.layout.StructBuilder.prototype.getPointerOffset = function() { return this.pointers; };
+
+capnp.layout.StructBuilder.prototype._getPointerField = function(ptrIndex) {
+  return this.segment.createWirePointerAt((this.pointers + ptrIndex) << 3);
+};
+
+capnp.layout.StructBuilder.prototype.setTextBlobField = function(ptrIndex, value) {
+  capnp.layout.setTextPointer(this._getPointerField(ptrIndex), this.segment, value);
+};
+
+capnp.layout.StructBuilder.prototype.setDataBlobField = function(ptrIndex, value) {
+  capnp.layout.setDataPointer(this._getPointerField(ptrIndex), this.segment, value);
+};
+
+capnp.layout.StructBuilder.prototype.getTextBlobField = function(ptrIndex, defaultValue, defaultSize) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.getWritableTextPointer(ref, ref.target(), this.segment, defaultValue, defaultSize);
+};
+
+capnp.layout.StructBuilder.prototype.disownTextBlobField = function(ptrIndex) {
+  return capnp.layout.disown(this.segment, this._getPointerField(ptrIndex));
+};
+
+capnp.layout.StructBuilder.prototype.disownDataBlobField = function(ptrIndex) {
+  return capnp.layout.disown(this.segment, this._getPointerField(ptrIndex));
+};
+
+capnp.layout.StructBuilder.prototype.getDataBlobField = function(ptrIndex, defaultValue, defaultSize) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.getWritableDataPointer(ref, ref.target(), this.segment, defaultValue, defaultSize);
+};
+
+capnp.layout.StructBuilder.prototype.getStructField = function(ptrIndex, size, defaultValue) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.getWritableStructPointer(ref, ref.target(), this.segment, size, defaultValue);
+};
+
+capnp.layout.StructBuilder.prototype.initStructField = function(ptrIndex, size) {
+  return capnp.layout.initStructPointer(this._getPointerField(ptrIndex), this.segment, size);
+};
+
+capnp.layout.StructBuilder.prototype.isPointerFieldNull = function(ptrIndex) {
+  var dataView = this.seg_dataView;
+  var offsetBytes = (this.pointers + ptrIndex) * capnp.common.BYTES_PER_WORD;
+  return dataView.getUint32(offsetBytes) === 0 && dataView.getUint32(offsetBytes + 4) === 0;
+};
+
+capnp.layout.StructBuilder.prototype.getListField = function(ptrIndex, elementSize, defaultValue) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.getWritableListPointer(ref, ref.target(), this.segment, elementSize, defaultValue);
+};
+
+capnp.layout.StructBuilder.prototype.getStructListField = function(ptrIndex, elementSize, defaultValue) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.getWritableStructListPointer(ref, ref.target(), this.segment, elementSize, defaultValue);
+};
+
+capnp.layout.StructBuilder.prototype.initStructListField = function(ptrIndex, elementCount, elementSize) {
+  return capnp.layout.initStructListPointer(this._getPointerField(ptrIndex), this.segment, elementCount, elementSize);
+};
+
+capnp.layout.StructBuilder.prototype.setListField = function(ptrIndex, value) {
+  capnp.layout.setListPointer(this.segment, this._getPointerField(ptrIndex), value);
+};
+
+capnp.layout.StructBuilder.prototype.initListField = function(ptrIndex, elementSize, elementCount) {
+  return capnp.layout.initListPointer(this._getPointerField(ptrIndex), this.segment, elementCount, elementSize);
+};
+
+capnp.layout.StructBuilder.prototype.disownListField = function(ptrIndex) {
+  return capnp.layout.disown(this.segment, this._getPointerField(ptrIndex));
+};
+
+capnp.layout.StructBuilder.prototype.clearPointerField = function(ptrIndex) {
+  var dataView = this.seg_dataView;
+  dataView.setUint32((this.pointers + ptrIndex) * capnp.common.BYTES_PER_WORD, 0);
+  dataView.setUint32((this.pointers + ptrIndex) * capnp.common.BYTES_PER_WORD + 4, 0);
+};
+
+capnp.layout.StructBuilder.prototype.setStructField = function(ptrIndex, value) {
+  goog.asserts.assert(value instanceof capnp.layout.StructReader, 'not a StructReader: ' + value);
+  capnp.layout.setStructPointer(this.segment, this._getPointerField(ptrIndex), value);
+};
+
+capnp.layout.StructBuilder.prototype.disownStructField = function(ptrIndex) {
+  return capnp.layout.disown(this.segment, this._getPointerField(ptrIndex));
+};
+
+capnp.layout.StructBuilder.prototype.adoptStructField = function(ptrIndex, value) {
+  return capnp.layout.adopt(this.segment, this._getPointerField(ptrIndex), value);
+};
+
+capnp.layout.StructBuilder.prototype.asReader = function() {
+  return new capnp.layout.StructReader(this.segment, this.data, this.pointers, this.dataSize, this.pointerCount, this.bit0Offset, Number.MAX_VALUE);
+};
+
+capnp.layout.StructBuilder.prototype.toString = function() { return 'StructBuilder{segment=' + this.segment.toString() + ',data=' + this.data + ', pointerOffset=' + this.pointers + '}'; };
+
 
 capnp.layout.StructBuilder.initRoot = function(segment, location, size) {
   return capnp.layout.initStructPointer(segment.createWirePointerAt(location), segment, size);
@@ -1545,63 +1680,66 @@ capnp.layout.StructReader = function(segment, data, pointers,
 
   capnp.layout.StructBase.call(this, segment, data, dataSize, bit0Offset);
 
-  this.segment = segment;
-  this.data = data;
   this.pointers = pointers;
-  this.dataSize = dataSize;
   this.pointerCount = pointerCount;
-  this.bit0Offset = bit0Offset;
   this.nestingLimit = nestingLimit;
+};
+capnp.layout.StructReader.prototype = Object.create(capnp.layout.StructBase.prototype);
+capnp.layout.StructReader.prototype.constructor = capnp.layout.StructReader;
 
-  this.getBit0Offset = function() { return bit0Offset; };
+capnp.layout.StructReader.prototype.getBit0Offset = function() { return this.bit0Offset; };
 
-  this.isPointerFieldNull = function(ptrIndex) {
-    var dataView = segment.getDataView();
-    var offsetBytes = (pointers + ptrIndex) * capnp.common.BYTES_PER_WORD;
-    return dataView.getUint32(offsetBytes) === 0 && dataView.getUint32(offsetBytes + 4) === 0;
-  };
+capnp.layout.StructReader.prototype.isPointerFieldNull = function(ptrIndex) {
+  if (ptrIndex >= this.pointerCount) {
+    return true;
+  }
+  var dataView = this.seg_dataView;
+  var offsetBytes = (this.pointers + ptrIndex) * capnp.common.BYTES_PER_WORD;
+  return dataView.getUint32(offsetBytes) === 0 && dataView.getUint32(offsetBytes + 4) === 0;
+};
 
-  this.getListField = function(ptrIndex, expectedElementSize, defaultValue) {
-    var ref = ptrIndex >= pointerCount ? capnp.layout.WirePointer.zero() : segment.createWirePointerAt((pointers + ptrIndex) << 3);
-    return capnp.layout.readListPointer(segment, ref, ref.target(), defaultValue, expectedElementSize, nestingLimit);
-  };
+capnp.layout.StructReader.prototype._getPointerField = function(ptrIndex) {
+  return ptrIndex >= this.pointerCount ? capnp.layout.WirePointer.zero() : this.segment.createWirePointerAt((this.pointers + ptrIndex) << 3);
+};
 
-  this.getStructField = function(ptrIndex, defaultValue) {
-    var ref = ptrIndex >= pointerCount ? capnp.layout.WirePointer.zero() : segment.createWirePointerAt((pointers + ptrIndex) << 3);
-    return capnp.layout.readStructPointer(segment, ref, ref.target(), defaultValue, nestingLimit);
-  };
+capnp.layout.StructReader.prototype.getListField = function(ptrIndex, expectedElementSize, defaultValue) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.readListPointer(this.segment, ref, ref.target(), defaultValue, expectedElementSize, this.nestingLimit);
+};
 
-  this.getTextBlobField = function(ptrIndex, defaultValue, defaultSize) {
-    var ref = ptrIndex >= pointerCount ? capnp.layout.WirePointer.zero() : segment.createWirePointerAt((pointers + ptrIndex) << 3);
-    return capnp.layout.readTextPointer(segment, ref, ref.target(), defaultValue, defaultSize);
-  };
+capnp.layout.StructReader.prototype.getStructField = function(ptrIndex, defaultValue) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.readStructPointer(this.segment, ref, ref.target(), defaultValue, this.nestingLimit);
+};
 
-  this.getDataBlobField = function(ptrIndex, defaultValue, defaultSize) {
-    goog.asserts.assert(kj.util.isRegularNumber(defaultSize), 'defaultSize not a regular number: ' + defaultSize);
-    var ref = ptrIndex >= pointerCount ? capnp.layout.WirePointer.zero() : segment.createWirePointerAt((pointers + ptrIndex) << 3);
-    return capnp.layout.readDataPointer(segment, ref, ref.target(), defaultValue, defaultSize);
-  };
+capnp.layout.StructReader.prototype.getTextBlobField = function(ptrIndex, defaultValue, defaultSize) {
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.readTextPointer(this.segment, ref, ref.target(), defaultValue, defaultSize);
+};
 
-  this.totalSize = function() {
-    var result = capnp.common.roundBitsUpToWords(dataSize) + pointerCount * capnp.common.WORDS_PER_POINTER;
+capnp.layout.StructReader.prototype.getDataBlobField = function(ptrIndex, defaultValue, defaultSize) {
+  goog.asserts.assert(kj.util.isRegularNumber(defaultSize), 'defaultSize not a regular number: ' + defaultSize);
+  var ref = this._getPointerField(ptrIndex);
+  return capnp.layout.readDataPointer(this.segment, ref, ref.target(), defaultValue, defaultSize);
+};
 
-    for (var i = 0; i < pointerCount; i++) {
-      result += capnp.layout.totalSize(segment, segment.createWirePointerAt((pointers + i) << 3), nestingLimit);
-    }
+capnp.layout.StructReader.prototype.totalSize = function() {
+  var result = capnp.common.roundBitsUpToWords(this.dataSize) + this.pointerCount * capnp.common.WORDS_PER_POINTER;
 
-    if (segment) {
-      // This traversal should not count against the read limit, because it's highly likely that
-      // the caller is going to traverse the object again, e.g. to copy it.
-      segment.unread(result);
-    }
+  for (var i = 0; i < this.pointerCount; i++) {
+    result += capnp.layout.totalSize(this.segment, this.segment.createWirePointerAt((this.pointers + i) << 3), this.nestingLimit);
+  }
 
-    return result;
-  };
+  if (this.segment) {
+    // This traversal should not count against the read limit, because it's highly likely that
+    // the caller is going to traverse the object again, e.g. to copy it.
+    this.segment.unread(result);
+  }
 
-  this.toString = function() { return 'StructReader{...}'; };
+  return result;
 };
-capnp.layout.StructReader.prototype = Object.create(capnp.layout.StructBase.prototype);
-capnp.layout.StructReader.prototype.constructor = capnp.layout.StructReader;
+
+capnp.layout.StructReader.prototype.toString = function() { return 'StructReader{...}'; };
 
 capnp.layout.StructReader.readRoot = function(location, segment, nestingLimit) {
 
@@ -1634,10 +1772,9 @@ capnp.layout.initListPointer = function(wirePointer, segmentBuilder, elementCoun
   var wordCount = capnp.common.roundBitsUpToWords(elementCount * step);
 
   // Allocate the list.
-  var allocateResult = capnp.layout.allocate(wirePointer, segmentBuilder, wordCount, capnp.layout.Kind.LIST, orphanArena);
-  var ptr = allocateResult[0];
-  segmentBuilder = allocateResult[1];
-  wirePointer = allocateResult[2];
+  var ptr = capnp.layout.allocate(wirePointer, segmentBuilder, wordCount, capnp.layout.Kind.LIST, orphanArena);
+  segmentBuilder = allocatedSegment;
+  wirePointer = allocatedRef;
 
   // Initialize the pointer.
   wirePointer.setListRef(elementSize, elementCount);
@@ -1793,10 +1930,9 @@ capnp.layout.getWritableStructPointer = function(ref, refTarget, segment, size,
     // Don't let allocate() zero out the object just yet.
     zeroPointerAndFars(segment, ref);
 
-    var allocateResult = capnp.layout.allocate(ref, segment, totalSize, capnp.layout.Kind.STRUCT, orphanArena);
-    var ptr = allocateResult[0];
-    segment = allocateResult[1];
-    ref = allocateResult[2];
+    var ptr = capnp.layout.allocate(ref, segment, totalSize, capnp.layout.Kind.STRUCT, orphanArena);
+    segment = allocatedSegment;
+    ref = allocatedRef;
     ref.setStructRef(new capnp.layout.StructSize(newDataSize, newPointerCount));
 
     // Copy data section.
@@ -2004,11 +2140,10 @@ capnp.layout.getWritableStructListPointer = function(origRef, origRefTarget, ori
     // Don't let allocate() zero out the object just yet.
     zeroPointerAndFars(origSegment, origRef);
 
-    var allocateResult = capnp.layout.allocate(origRef, origSegment, totalSize + capnp.common.POINTER_SIZE_IN_WORDS,
-                                               capnp.layout.Kind.LIST, orphanArena);
-    var newPtr = allocateResult[0];
-    origSegment = allocateResult[1];
-    origRef = allocateResult[2];
+    var newPtr = capnp.layout.allocate(origRef, origSegment, totalSize + capnp.common.POINTER_SIZE_IN_WORDS,
+                                       capnp.layout.Kind.LIST, orphanArena);
+    origSegment = allocatedSegment;
+    origRef = allocatedRef;
     origRef.setListRefInlineComposite(totalSize);
 
     var newTag = origSegment.createWirePointerAt(newPtr << 3);
@@ -2119,11 +2254,10 @@ capnp.layout.getWritableStructListPointer = function(origRef, origRefTarget, ori
       // Don't let allocate() zero out the object just yet.
       zeroPointerAndFars(origSegment, origRef);
 
-      var allocateResult = capnp.layout.allocate(origRef, origSegment, totalWords + capnp.common.POINTER_SIZE_IN_WORDS,
-                                                 capnp.layout.Kind.LIST, orphanArena);
-      var newPtr = allocateResult[0];
-      origSegment = allocateResult[1];
-      origRef = allocateResult[2];
+      var newPtr = capnp.layout.allocate(origRef, origSegment, totalWords + capnp.common.POINTER_SIZE_IN_WORDS,
+                                         capnp.layout.Kind.LIST, orphanArena);
+      origSegment = allocatedSegment;
+      origRef = allocatedRef;
       origRef.setListRefInlineComposite(totalWords);
 
       var tag = origSegment.createWirePointerAt(newPtr << 3);
@@ -2188,10 +2322,9 @@ capnp.layout.getWritableStructListPointer = function(origRef, origRefTarget, ori
       // Don't let allocate() zero out the object just yet.
       zeroPointerAndFars(origSegment, origRef);
 
-      var allocateResult = capnp.layout.allocate(origRef, origSegment, totalWords, capnp.layout.Kind.LIST, orphanArena);
-      var newPtr = allocateResult[0];
-      origSegment = allocateResult[1];
-      origRef = allocateResult[2];
+      var newPtr = capnp.layout.allocate(origRef, origSegment, totalWords, capnp.layout.Kind.LIST, orphanArena);
+      origSegment = allocatedSegment;
+      origRef = allocatedRef;
       origRef.setListRef(preferredListEncoding, elementCount);
 
       var newBytePtr = newPtr << 3;
@@ -2567,10 +2700,9 @@ capnp.layout.setListPointer = function(segment, ref, value, orphanArena) {
   if (value.step <= capnp.common.BITS_PER_WORD) {
 
     // List of non-structs.
-    var allocateResult = capnp.layout.allocate(ref, segment, totalSize, capnp.layout.Kind.LIST, orphanArena);
-    var ptr = allocateResult[0];
-    segment = allocateResult[1];
-    ref = allocateResult[2];
+    var ptr = capnp.layout.allocate(ref, segment, totalSize, capnp.layout.Kind.LIST, orphanArena);
+    segment = allocatedSegment;
+    ref = allocatedRef;
 
     if (value.structPointerCount === 1) {
 
@@ -2610,11 +2742,10 @@ capnp.layout.setListPointer = function(segment, ref, value, orphanArena) {
   } else {
 
     // List of structs.
-    var allocateResult = capnp.layout.allocate(ref, segment, totalSize + capnp.common.POINTER_SIZE_IN_WORDS, capnp.layout.Kind.LIST,
-                                               orphanArena);
-    var ptr = allocateResult[0];
-    segment = allocateResult[1];
-    ref = allocateResult[2];
+    var ptr = capnp.layout.allocate(ref, segment, totalSize + capnp.common.POINTER_SIZE_IN_WORDS, capnp.layout.Kind.LIST,
+                                    orphanArena);
+    segment = allocatedSegment;
+    ref = allocatedRef;
     ref.setListRefInlineComposite(totalSize);
 
     var dataSize = capnp.common.roundBitsUpToWords(value.structDataSize);
@@ -2759,10 +2890,9 @@ capnp.layout.setStructPointer = function(segment, ref, value, orphanArena) {
   var dataSize = capnp.common.roundBitsUpToWords(value.dataSize);
   var totalSize = dataSize + value.pointerCount;
 
-  var allocateResult = capnp.layout.allocate(ref, segment, totalSize, capnp.layout.Kind.STRUCT, orphanArena);
-  var ptr = allocateResult[0];
-  segment = allocateResult[1];
-  ref = allocateResult[2];
+  var ptr = capnp.layout.allocate(ref, segment, totalSize, capnp.layout.Kind.STRUCT, orphanArena);
+  segment = allocatedSegment;
+  ref = allocatedRef;
   ref.setStructRef(new capnp.layout.StructSize(dataSize, value.pointerCount));
 
   if (value.dataSize === 1) {
@@ -2787,14 +2917,17 @@ capnp.layout.setStructPointer = function(segment, ref, value, orphanArena) {
  * @constructor
  */
 capnp.layout.StructSize = function(dataWordCount, pointerCount, preferredListEncoding) {
-  this.getDataWordCount = function() { return dataWordCount; };
-  this.getPointerCount = function() { return pointerCount; };
-  this.getPreferredListEncoding = function() { return preferredListEncoding; };
-  this.getTotal = function() { return dataWordCount + pointerCount * capnp.common.WORDS_PER_POINTER; };
-  this.toString = function() { return 'StructSize(dataWordCount=' + dataWordCount + ',pointerCount=' + pointerCount + ',preferredListEncoding=' + preferredListEncoding + ')'; };
-  return this;
+  this.dataWordCount = dataWordCount;
+  this.pointerCount = pointerCount;
+  this.preferredListEncoding = preferredListEncoding;
 };
 
+capnp.layout.StructSize.prototype.getDataWordCount = function() { return this.dataWordCount; };
+capnp.layout.StructSize.prototype.getPointerCount = function() { return this.pointerCount; };
+capnp.layout.StructSize.prototype.getPreferredListEncoding = function() { return this.preferredListEncoding; };
+capnp.layout.StructSize.prototype.getTotal = function() { return this.dataWordCount + this.pointerCount * capnp.common.WORDS_PER_POINTER; };
+capnp.layout.StructSize.prototype.toString = function() { return 'StructSize(dataWordCount=' + this.dataWordCount + ',pointerCount=' + this.pointerCount + ',preferredListEncoding=' + this.preferredListEncoding + ')'; };
+
 capnp.layout.disown = function(segment, ref) {
 
   var location;
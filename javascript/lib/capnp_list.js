@@ -39,6 +39,8 @@ var primitiveClasses = [
   capnp.prim.uint32_t,
   capnp.prim.int64_t,
   capnp.prim.uint64_t,
+  capnp.prim.bigint64_t,
+  capnp.prim.biguint64_t,
   capnp.prim.float32_t,
   capnp.prim.float64_t,
   capnp.prim.bool,
@@ -87,8 +89,103 @@ capnp.list.List.prototype.getNewOrphanList = function(arena, size) {
   return capnp.layout.OrphanBuilder.initList(arena, size, this.getElementSize());
 };
 
+// List types are stateless, so each factory hands out one instance per
+// element class.  Generated code asks for them on every field access.
+var listOfPrimitivesCache = new Map();
+var listOfListsCache = new Map();
+var listOfBlobsCache = new Map();
+var listOfStructsCache = new Map();
+var listOfEnums = null;
+
+/** @const */ var hostIsLittleEndian = new Uint8Array(new Uint16Array([1]).buffer)[0] === 1;
+
+/**
+ *  True if the elements of `list' are laid out exactly like the contents of
+ *  a `TypedArray', so that they can be viewed or copied as raw bytes.
+ */
+var isTightlyPacked = function(TypedArray, list) {
+  return hostIsLittleEndian &&
+    list.step === TypedArray.BYTES_PER_ELEMENT * capnp.common.BITS_PER_BYTE;
+};
+
+/**
+ *  Return the elements of `list', a ListReader or ListBuilder of
+ *  primitives, as an instance of `clazz.TypedArray'.  When the list is
+ *  tightly packed and suitably aligned (and the host is little-endian)
+ *  the result aliases the segment, otherwise it is a copy.
+ */
+capnp.list.asTypedArray = function(clazz, list) {
+
+  kj.debug.REQUIRE(clazz.TypedArray, 'List element type has no typed array representation.');
+
+  var TypedArray = clazz.TypedArray;
+  var elementCount = list.elementCount;
+  if (elementCount === 0) {
+    return new TypedArray(0);
+  }
+
+  var dataView = list.segment.getDataView();
+  var byteOffset = dataView.byteOffset + (list.ptr << 3);
+  var result;
+  if (isTightlyPacked(TypedArray, list)) {
+    if (byteOffset % TypedArray.BYTES_PER_ELEMENT === 0) {
+      return new TypedArray(dataView.buffer, byteOffset, elementCount);
+    }
+    // The segment itself is misaligned within its buffer; copy the bytes over in one go.
+    result = new TypedArray(elementCount);
+    new Uint8Array(result.buffer).set(
+      new Uint8Array(dataView.buffer, byteOffset, elementCount * TypedArray.BYTES_PER_ELEMENT));
+    return result;
+  }
+
+  result = new TypedArray(elementCount);
+  for (var i = 0; i < elementCount; ++i) {
+    result[i] = list.getDataElement(clazz, i);
+  }
+  return result;
+};
+
+/**
+ *  Overwrite all elements of `list', a ListBuilder of primitives, with
+ *  those of `array', which must have the same length.  `array' is
+ *  converted to `clazz.TypedArray' first if necessary, and then copied
+ *  into the segment with a single Uint8Array.set() where the layout
+ *  allows it.
+ */
+capnp.list.setAll = function(clazz, list, array) {
+
+  kj.debug.REQUIRE(clazz.TypedArray, 'List element type has no typed array representation.');
+  kj.debug.REQUIRE(array.length === list.elementCount,
+                   'Expected ' + list.elementCount + ' elements but got ' + array.length + '.');
+
+  var TypedArray = clazz.TypedArray;
+  var elementCount = list.elementCount;
+  if (elementCount === 0) {
+    return;
+  }
+
+  if (isTightlyPacked(TypedArray, list)) {
+    if (!(array instanceof TypedArray)) {
+      // BigInt arrays don't convert plain numbers implicitly, setValue() does.
+      array = clazz === capnp.prim.bigint64_t || clazz === capnp.prim.biguint64_t
+        ? TypedArray.from(array, BigInt) : new TypedArray(array);
+    }
+    list.segment.getUint8Array().set(
+      new Uint8Array(array.buffer, array.byteOffset, array.byteLength), list.ptr << 3);
+    return;
+  }
+
+  for (var i = 0; i < elementCount; ++i) {
+    list.setDataElement(clazz, i, array[i]);
+  }
+};
+
 capnp.list.ListOfPrimitives = function(clazz, defaultElementSize) {
 
+  if (!defaultElementSize && listOfPrimitivesCache.has(clazz)) {
+    return listOfPrimitivesCache.get(clazz);
+  }
+
   /**
    * @constructor
    */
@@ -159,6 +256,38 @@ capnp.list.ListOfPrimitives = function(clazz, defaultElementSize) {
       this.getReaderAsFieldOf(reader, index, defaultValue));
   };
 
+  subType.prototype.toArray = function(list) {
+    var elementCount = list.elementCount;
+    var result = new Array(elementCount);
+    if (elementCount > 0) {
+      var dataView = list.segment.getDataView();
+      var offset = list.ptr * capnp.common.BITS_PER_WORD;
+      for (var i = 0; i < elementCount; ++i) {
+        result[i] = clazz.getValue(dataView, offset + i * list.step);
+      }
+    }
+    return result;
+  };
+
+  subType.prototype.initFrom = function(builder, index, array) {
+    var list = this.initBuilderAsFieldOf(builder, index, array.length);
+    capnp.list.setAll(clazz, list, array);
+    return new this.Builder(list);
+  };
+
+  subType.prototype.fromArray = function(list, array) {
+    if (clazz.TypedArray) {
+      capnp.list.setAll(clazz, list, array);
+      return list;
+    }
+    var dataView = list.segment.getDataView();
+    var offset = list.ptr * capnp.common.BITS_PER_WORD;
+    for (var i = 0, len = array.length; i < len; ++i) {
+      clazz.setValue(dataView, offset + i * list.step, array[i]);
+    }
+    return list;
+  };
+
   /**
    * @constructor
    */
@@ -187,6 +316,10 @@ capnp.list.ListOfPrimitives = function(clazz, defaultElementSize) {
       return _reader.getDataElement(clazz, index);
     };
 
+    this.asTypedArray = function() {
+      return capnp.list.asTypedArray(clazz, _reader);
+    };
+
     this.toString = function() {
       var result = '[ ';
 
@@ -232,6 +365,14 @@ capnp.list.ListOfPrimitives = function(clazz, defaultElementSize) {
         }
         _builder.setDataElement(clazz, index, value);
       };
+
+      this.asTypedArray = function() {
+        return capnp.list.asTypedArray(clazz, _builder);
+      };
+
+      this.setAll = function(array) {
+        capnp.list.setAll(clazz, _builder, array);
+      };
     });
   };
 
@@ -245,11 +386,17 @@ capnp.list.ListOfPrimitives = function(clazz, defaultElementSize) {
     return instance;
   };
 
+  if (!defaultElementSize) {
+    listOfPrimitivesCache.set(clazz, instance);
+  }
   return instance;
 };
 
 capnp.list.ListOfEnums = function(clazz) {
-  return capnp.list.ListOfPrimitives(capnp.prim.uint16_t, capnp.layout.FieldSize.TWO_BYTES);
+  if (listOfEnums === null) {
+    listOfEnums = capnp.list.ListOfPrimitives(capnp.prim.uint16_t, capnp.layout.FieldSize.TWO_BYTES);
+  }
+  return listOfEnums;
 };
 
 
@@ -258,7 +405,11 @@ capnp.list.ListOfEnums = function(clazz) {
  */
 capnp.list.ListOfLists = function(clazz) {
 
-  return {
+  if (listOfListsCache.has(clazz)) {
+    return listOfListsCache.get(clazz);
+  }
+
+  var instance = {
     type: 'ListsOfLists',
 
     getElementSize: function() {
@@ -266,11 +417,15 @@ capnp.list.ListOfLists = function(clazz) {
     },
 
     getReaderAsElementOf: function(reader, index, defaultValue) {
-      return reader.getListField(index, capnp.layout.FieldSize.POINTER, defaultValue);
+      return reader.getListElement(index, capnp.layout.FieldSize.POINTER);
     },
 
     getBuilderAsElementOf: function(builder, index, defaultValue) {
-      return builder.getListField(index, capnp.layout.FieldSize.POINTER, defaultValue);
+      return builder.getListElement(index, capnp.layout.FieldSize.POINTER);
+    },
+
+    initBuilderAsElementOf: function(builder, index, size) {
+      return builder.initListElement(index, capnp.layout.FieldSize.POINTER, size);
     },
 
     getReaderAsFieldOf: function(reader, index, defaultValue) {
@@ -297,6 +452,24 @@ capnp.list.ListOfLists = function(clazz) {
       return new this.Builder(this.initBuilderAsFieldOf(builder, index, size));
     },
 
+    toArray: function(list) {
+      var result = new Array(list.elementCount);
+      for (var i = 0, len = list.elementCount; i < len; ++i) {
+        result[i] = clazz.toArray(clazz.getReaderAsElementOf(list, i));
+      }
+      return result;
+    },
+
+    fromArray: function(list, array) {
+      for (var i = 0, len = array.length; i < len; ++i) {
+        var element = array[i];
+        if (element != null) {
+          clazz.fromArray(clazz.initBuilderAsElementOf(list, i, element.length), element);
+        }
+      }
+      return list;
+    },
+
     /**
      * @constructor
      */
@@ -403,11 +576,18 @@ capnp.list.ListOfLists = function(clazz) {
       return this;
     }
   };
+
+  listOfListsCache.set(clazz, instance);
+  return instance;
 };
 capnp.list.ListOfLists.prototype = new capnp.list.List();
 
 capnp.list.ListOfBlobs = function(clazz) {
 
+  if (listOfBlobsCache.has(clazz)) {
+    return listOfBlobsCache.get(clazz);
+  }
+
   /**
    * @constructor
    */
@@ -450,6 +630,24 @@ capnp.list.ListOfBlobs = function(clazz) {
       return new this.Builder(this.getBuilderAsFieldOf(builder, index, defaultValue));
     };
 
+    this.toArray = function(list) {
+      var isText = clazz === capnp.blob.Text;
+      var result = new Array(list.elementCount);
+      for (var i = 0, len = list.elementCount; i < len; ++i) {
+        result[i] = isText ? list.getTextBlobElement(i).str() : capnp.blob.copyDataBytes(list.getDataBlobElement(i));
+      }
+      return result;
+    };
+
+    this.fromArray = function(list, array) {
+      for (var i = 0, len = array.length; i < len; ++i) {
+        if (array[i] != null) {
+          clazz.setElement(list, i, array[i]);
+        }
+      }
+      return list;
+    };
+
     /**
      * @constructor
      */
@@ -539,13 +737,19 @@ capnp.list.ListOfBlobs = function(clazz) {
   };
   subType.prototype = new capnp.list.List();
   subType.prototype.constructor = subType;
-  return new subType;
+  var instance = new subType;
+  listOfBlobsCache.set(clazz, instance);
+  return instance;
 };
 capnp.list.ListOfBlobs.prototype = new capnp.list.List();
 
 
 capnp.list.ListOfStructs = function(clazz) {
 
+  if (listOfStructsCache.has(clazz)) {
+    return listOfStructsCache.get(clazz);
+  }
+
   /**
    * @constructor
    */
@@ -600,6 +804,31 @@ capnp.list.ListOfStructs = function(clazz) {
       return capnp.layout.OrphanBuilder.initStructList(arena, size, clazz.STRUCT_SIZE);
     };
 
+    this.toArray = function(list) {
+      var elementCount = list.elementCount;
+      var result = new Array(elementCount);
+      if (elementCount > 0) {
+        // clazz.toObject() doesn't hold on to its reader, so one will do for all elements.
+        var element = list.getStructElement(0);
+        result[0] = clazz.toObject(element);
+        for (var i = 1; i < elementCount; ++i) {
+          result[i] = clazz.toObject(list.moveToStructElement(element, i));
+        }
+      }
+      return result;
+    };
+
+    this.fromArray = function(list, array) {
+      var element = null;
+      for (var i = 0, len = array.length; i < len; ++i) {
+        if (array[i] != null) {
+          element = element === null ? list.getStructElement(i) : list.moveToStructElement(element, i);
+          clazz.fromObject(element, array[i]);
+        }
+      }
+      return list;
+    };
+
     /**
      * @constructor
      */
@@ -666,6 +895,8 @@ capnp.list.ListOfStructs = function(clazz) {
     };
   };
   subType.prototype = new capnp.list.List();
-  return new subType;
+  var instance = new subType;
+  listOfStructsCache.set(clazz, instance);
+  return instance;
 };
 capnp.list.ListOfStructs.prototype = new capnp.list.List();
@@ -25,9 +25,16 @@
 
 goog.provide('capnp.message');
 
+goog.require('goog.asserts');
+
 goog.require('kj.debug');
+goog.require('kj.util');
 
-var defaultReaderOptions = {
+/**
+ * Reader options used where none are given.
+ * @const
+ */
+capnp.message.DEFAULT_READER_OPTIONS = {
   traversalLimitInWords: 8 * 1024 * 1024,
   nestingLimit: 64
 };
@@ -58,8 +65,8 @@ capnp.message.AllocationStrategy = {
 capnp.message.MessageReader = function(options) {
 
   this.options = {};
-  this.options.traversalLimitInWords = (options && options.traversalLimitInWords) || defaultReaderOptions.traversalLimitInWords;
-  this.options.nestingLimit = (options && options.nestingLimit) || defaultReaderOptions.nestingLimit;
+  this.options.traversalLimitInWords = (options && options.traversalLimitInWords) || capnp.message.DEFAULT_READER_OPTIONS.traversalLimitInWords;
+  this.options.nestingLimit = (options && options.nestingLimit) || capnp.message.DEFAULT_READER_OPTIONS.nestingLimit;
 
   return this;
 };
@@ -188,8 +195,25 @@ capnp.message.MessageBuilder.prototype.getRootSegment = function() {
   }
   else {
     this.arena = new capnp.arena.BuilderArena(this);
-    var allocation = this.arena.allocate(capnp.common.POINTER_SIZE_IN_WORDS);
-    return allocation.segment;
+    return this.arena.allocate(capnp.common.POINTER_SIZE_IN_WORDS);
+  }
+};
+
+capnp.message.MessageBuilder.prototype.returnSegment = function(segment) {
+  // Called by BuilderArena.reset() for segments it no longer uses.  By default they are simply
+  // dropped.
+};
+
+/**
+ * Discards the message content so that the builder can be used for a new message, keeping the
+ * segments allocated so far.  Only the used part of each segment is zeroed.
+ */
+capnp.message.MessageBuilder.prototype.reset = function() {
+  if (this.arena) {
+    this.arena.reset();
+
+    // Re-allocate the root pointer, which is always the first word of the first segment.
+    this.arena.allocate(capnp.common.POINTER_SIZE_IN_WORDS);
   }
 };
 
@@ -205,28 +229,92 @@ capnp.message.MessageBuilder.prototype.getSegmentsForOutput = function() {
   }
 };
 
+/**
+ * A pool of zeroed segment buffers, shared by any number of MallocMessageBuilders.  Builders
+ * borrow their segments from the pool and give them back on dispose().
+ *
+ * @constructor
+ * @param {number=} maxPooledWords Upper limit for the total size of the pooled buffers.
+ */
+capnp.message.SegmentPool = function(maxPooledWords) {
+  this.maxPooledWords = maxPooledWords === undefined ? 8 * 1024 * 1024 : maxPooledWords;
+  this.pooledWords = 0;
+  this.buffers = [];
+};
+
+/**
+ * @param {number} minimumSize in words.
+ * @return {ArrayBuffer} A zeroed buffer of at least minimumSize words, or null if there is none.
+ */
+capnp.message.SegmentPool.prototype.acquire = function(minimumSize) {
+  var buffers = this.buffers;
+  for (var i = buffers.length - 1; i >= 0; --i) {
+    var buffer = buffers[i];
+    if (buffer.byteLength >= minimumSize * capnp.common.BYTES_PER_WORD) {
+      buffers[i] = buffers[buffers.length - 1];
+      buffers.pop();
+      this.pooledWords -= buffer.byteLength >>> 3;
+      return buffer;
+    }
+  }
+  return null;
+};
+
+/**
+ * @param {ArrayBuffer} buffer A buffer which must be completely zeroed.
+ */
+capnp.message.SegmentPool.prototype.release = function(buffer) {
+  var words = buffer.byteLength >>> 3;
+  if (this.pooledWords + words <= this.maxPooledWords) {
+    this.buffers.push(buffer);
+    this.pooledWords += words;
+  }
+};
+
 /**
  * @constructor
  * @extends capnp.message.MessageBuilder
+ * @param {number|ArrayBuffer=} firstSegment Either the size of the first segment in words or,
+ *     to avoid allocating it, a buffer to use as the first segment.  The buffer is zeroed and
+ *     belongs to the builder until the builder is no longer used.
+ * @param {capnp.message.AllocationStrategy=} allocationStrategy
+ * @param {capnp.message.SegmentPool=} pool Where to take segments from and return them to.
  */
-capnp.message.MallocMessageBuilder = function(firstSegmentWords, allocationStrategy) {
+capnp.message.MallocMessageBuilder = function(firstSegment, allocationStrategy, pool) {
+
+  capnp.message.MessageBuilder.call(this);
 
   var SUGGESTED_ALLOCATION_STRATEGY = capnp.message.AllocationStrategy.GROW_HEURISTICALLY;
 
-  if (firstSegmentWords === undefined) {
-    firstSegmentWords = 1024;
+  if (firstSegment === undefined) {
+    firstSegment = 1024;
   }
   if (allocationStrategy === undefined) {
     allocationStrategy = SUGGESTED_ALLOCATION_STRATEGY;
   }
   this.allocationStrategy = allocationStrategy;
+  this.pool = pool || null;
 
-  var self = this;
-  this.nextSize = firstSegmentWords;
-  this.ownFirstSegment = true;
   this.returnedFirstSegment = false;
-  this.firstSegment = null;
   this.moreSegments = [];
+
+  // Segments handed back by reset(), zeroed and ready for reuse.
+  this.spareSegments = [];
+
+  if (kj.util.isArrayBuffer(firstSegment)) {
+    kj.debug.REQUIRE(firstSegment.byteLength >= capnp.common.BYTES_PER_WORD,
+                     'First segment must hold at least one word.');
+    new Uint8Array(firstSegment).fill(0);
+    this.initialSize = firstSegment.byteLength >>> 3;
+    this.ownFirstSegment = false;
+    this.firstSegment = firstSegment;
+  }
+  else {
+    this.initialSize = firstSegment;
+    this.ownFirstSegment = true;
+    this.firstSegment = null;
+  }
+  this.nextSize = this.initialSize;
 };
 
 goog.inherits(capnp.message.MallocMessageBuilder, capnp.message.MessageBuilder);
@@ -274,24 +362,97 @@ capnp.message.MallocMessageBuilder.prototype.getOrphanage = function() {
 
 capnp.message.MallocMessageBuilder.prototype.allocateSegment = function(minimumSize) {
 
+  if (!this.returnedFirstSegment && !this.ownFirstSegment) {
+    if (this.firstSegment.byteLength >= minimumSize * capnp.common.BYTES_PER_WORD) {
+      this.returnedFirstSegment = true;
+      return new DataView(this.firstSegment);
+    }
+
+    // If the provided first segment wasn't big enough, we discard it and proceed to allocate our
+    // own.  This never happens in practice since minimumSize is always 1 for the first segment.
+    this.ownFirstSegment = true;
+  }
+
   var size = Math.max(minimumSize, this.nextSize);
 
-  var result = new ArrayBuffer(size * capnp.common.BYTES_PER_WORD);
+  // Prefer memory we already have.  Any zeroed buffer that is large enough will do.
+  var result = takeBuffer(this.spareSegments, minimumSize);
+  var reused = result !== null;
+  if (result === null && this.pool !== null) {
+    result = this.pool.acquire(minimumSize);
+  }
+  if (result === null) {
+    result = new ArrayBuffer(size * capnp.common.BYTES_PER_WORD);
+  }
+
+  // A spare segment is already counted in nextSize.
+  var growth = reused ? 0 : result.byteLength >>> 3;
 
   if (!this.returnedFirstSegment) {
     this.firstSegment = result;
     this.returnedFirstSegment = true;
 
     // After the first segment, we want nextSize to equal the total size allocated so far.
-    if (this.allocationStrategy === capnp.message.AllocationStrategy.GROW_HEURISTICALLY) this.nextSize = size;
+    if (this.allocationStrategy === capnp.message.AllocationStrategy.GROW_HEURISTICALLY) this.nextSize = growth;
   } else {
     this.moreSegments.push(result);
-    if (this.allocationStrategy === capnp.message.AllocationStrategy.GROW_HEURISTICALLY) this.nextSize += size;
+    if (this.allocationStrategy === capnp.message.AllocationStrategy.GROW_HEURISTICALLY) this.nextSize += growth;
   }
 
   return new DataView(result);
 };
 
+capnp.message.MallocMessageBuilder.prototype.returnSegment = function(segment) {
+  var buffer = segment.buffer;
+  var index = this.moreSegments.indexOf(buffer);
+  goog.asserts.assert(index >= 0, 'returnSegment got a segment it did not allocate');
+  this.moreSegments.splice(index, 1);
+  this.spareSegments.push(buffer);
+};
+
+/**
+ * Discards the message and gives all segments owned by this builder back to its pool.  The
+ * builder may be used again afterwards and will then allocate new segments.
+ */
+capnp.message.MallocMessageBuilder.prototype.dispose = function() {
+
+  // Zero everything that was used, which also moves all but the first segment to spareSegments.
+  if (this.arena) {
+    this.arena.reset();
+    this.arena = null;
+  }
+
+  if (this.pool !== null) {
+    if (this.returnedFirstSegment && this.ownFirstSegment) {
+      this.pool.release(this.firstSegment);
+    }
+    for (var i = 0, len = this.spareSegments.length; i < len; i++) {
+      this.pool.release(this.spareSegments[i]);
+    }
+  }
+
+  if (this.ownFirstSegment) {
+    this.firstSegment = null;
+  }
+  this.returnedFirstSegment = false;
+  this.moreSegments = [];
+  this.spareSegments = [];
+
+  // The grown size counted the spare segments dropped above.
+  this.nextSize = this.initialSize;
+};
+
+var takeBuffer = function(buffers, minimumSize) {
+  for (var i = 0, len = buffers.length; i < len; i++) {
+    var buffer = buffers[i];
+    if (buffer.byteLength >= minimumSize * capnp.common.BYTES_PER_WORD) {
+      buffers.splice(i, 1);
+      return buffer;
+    }
+  }
+  return null;
+};
+
 
 capnp.message.readMessageUnchecked = function(type, data) {
   return new type.Reader(capnp.layout.StructReader.readRootUnchecked(data));
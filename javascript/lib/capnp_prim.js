@@ -38,6 +38,9 @@ capnp.prim.asUint64Val = function(args) {
   else if (args.length == 1 && goog.isArray(args[0]) && kj.util.isNumber(args[0][0]) && kj.util.isNumber(args[0][1])) {
     return { hi: args[0][0], lo: args[0][1] };
   }
+  else if (args.length == 1 && typeof args[0] === 'bigint') {
+    return { hi: Number(BigInt.asUintN(32, args[0] >> BigInt(32))), lo: Number(BigInt.asUintN(32, args[0])) };
+  }
   else if (args[0].hasOwnProperty('remainder') && args[0].hasOwnProperty('divideAndRemainder')) {
     throw new TypeError('appears to be bigdeciaml');
   }
@@ -71,6 +74,7 @@ capnp.prim.bool = {
 
 capnp.prim.int8_t = {
   elementSize: capnp.layout.FieldSize.BYTE,
+  TypedArray: Int8Array,
   setValue: function(dataView, offset, value) {
     dataView.setInt8(offset / capnp.common.BITS_PER_BYTE, value);
   },
@@ -86,6 +90,7 @@ capnp.prim.int8_t = {
 
 capnp.prim.int16_t = {
   elementSize: capnp.layout.FieldSize.TWO_BYTES,
+  TypedArray: Int16Array,
   setValue: function(dataView, offset, value) {
     dataView.setInt16(offset / capnp.common.BITS_PER_BYTE, value, true);
   },
@@ -100,6 +105,7 @@ capnp.prim.int16_t = {
 
 capnp.prim.int32_t = {
   elementSize: capnp.layout.FieldSize.FOUR_BYTES,
+  TypedArray: Int32Array,
   setValue: function(dataView, offset, value) {
     dataView.setInt32(offset / capnp.common.BITS_PER_BYTE, value, true);
   },
@@ -136,6 +142,7 @@ capnp.prim.int64_t = {
 
 capnp.prim.uint8_t = {
   elementSize: capnp.layout.FieldSize.BYTE,
+  TypedArray: Uint8Array,
   setValue: function(dataView, offset, value) {
     dataView.setUint8(offset / capnp.common.BITS_PER_BYTE, value);
   },
@@ -150,6 +157,7 @@ capnp.prim.uint8_t = {
 
 capnp.prim.uint16_t = {
   elementSize: capnp.layout.FieldSize.TWO_BYTES,
+  TypedArray: Uint16Array,
   setValue: function(dataView, offset, value) {
     dataView.setUint16(offset / capnp.common.BITS_PER_BYTE, value, true);
   },
@@ -165,6 +173,7 @@ capnp.prim.uint16_t = {
 
 capnp.prim.uint32_t = {
   elementSize: capnp.layout.FieldSize.FOUR_BYTES,
+  TypedArray: Uint32Array,
   setValue: function(dataView, offset, value) {
     dataView.setUint32(offset / capnp.common.BITS_PER_BYTE, value, true);
   },
@@ -200,8 +209,57 @@ capnp.prim.uint64_t = {
   }
 };
 
+/**
+ *  BigInt counterparts of int64_t and uint64_t, used by code generated
+ *  with `capnpc-js --bigint'.  Values go straight through
+ *  DataView.getBigInt64 and friends instead of being split into a
+ *  [hi, lo] pair.
+ */
+capnp.prim.bigint64_t = {
+  elementSize: capnp.layout.FieldSize.EIGHT_BYTES,
+  TypedArray: typeof BigInt64Array !== 'undefined' ? BigInt64Array : undefined,
+  setValue: function(dataView, offset, value) {
+    dataView.setBigInt64(offset / capnp.common.BITS_PER_BYTE, BigInt(value), true);
+  },
+  getValue: function(dataView, offset) {
+    return dataView.getBigInt64(offset / capnp.common.BITS_PER_BYTE, true);
+  }
+};
+
+capnp.prim.biguint64_t = {
+  elementSize: capnp.layout.FieldSize.EIGHT_BYTES,
+  TypedArray: typeof BigUint64Array !== 'undefined' ? BigUint64Array : undefined,
+  setValue: function(dataView, offset, value) {
+    dataView.setBigUint64(offset / capnp.common.BITS_PER_BYTE, BigInt(value), true);
+  },
+  getValue: function(dataView, offset) {
+    return dataView.getBigUint64(offset / capnp.common.BITS_PER_BYTE, true);
+  }
+};
+
+/**
+ *  Convert between the [hi, lo] pairs returned by int64_t/uint64_t and
+ *  BigInt, for code that has to deal with both representations.
+ */
+capnp.prim.int64ToBigInt = function(value) {
+  return BigInt.asIntN(64, (BigInt(value[0] | 0) << BigInt(32)) | BigInt(value[1] >>> 0));
+};
+
+capnp.prim.uint64ToBigInt = function(value) {
+  return BigInt.asUintN(64, (BigInt(value[0] >>> 0) << BigInt(32)) | BigInt(value[1] >>> 0));
+};
+
+capnp.prim.bigIntToInt64 = function(value) {
+  return [Number(BigInt.asIntN(32, value >> BigInt(32))), Number(BigInt.asIntN(32, value))];
+};
+
+capnp.prim.bigIntToUint64 = function(value) {
+  return [Number(BigInt.asUintN(32, value >> BigInt(32))), Number(BigInt.asUintN(32, value))];
+};
+
 capnp.prim.float32_t = {
   elementSize: capnp.layout.FieldSize.FOUR_BYTES,
+  TypedArray: Float32Array,
   setValue: function(dataView, offset, value) {
     dataView.setFloat32(offset / capnp.common.BITS_PER_BYTE, value, true);
   },
@@ -216,6 +274,7 @@ capnp.prim.float32_t = {
 
 capnp.prim.float64_t = {
   elementSize: capnp.layout.FieldSize.EIGHT_BYTES,
+  TypedArray: Float64Array,
   setValue: function(dataView, offset, value) {
     dataView.setFloat64(offset / capnp.common.BITS_PER_BYTE, value, true);
   },
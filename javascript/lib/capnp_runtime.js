@@ -56,11 +56,17 @@ goog.require('capnp.serialize');
   exports['uint16_t']  = capnp.prim.uint16_t;
   exports['uint32_t']  = capnp.prim.uint32_t;
   exports['uint64_t']  = capnp.prim.uint64_t;
+  exports['bigint64_t']  = capnp.prim.bigint64_t;
+  exports['biguint64_t'] = capnp.prim.biguint64_t;
   exports['float32_t'] = capnp.prim.float32_t;
   exports['float64_t'] = capnp.prim.float64_t;
   exports['Void']      = capnp.prim.Void;
   exports['asUint64Val'] = capnp.prim.asUint64Val;
   exports['asInt64Val'] = capnp.prim.asUint64Val;
+  exports['int64ToBigInt'] = capnp.prim.int64ToBigInt;
+  exports['uint64ToBigInt'] = capnp.prim.uint64ToBigInt;
+  exports['bigIntToInt64'] = capnp.prim.bigIntToInt64;
+  exports['bigIntToUint64'] = capnp.prim.bigIntToUint64;
 
   exports['List'] = capnp.list.List;
   exports['ListOfPrimitives'] = capnp.list.ListOfPrimitives;
@@ -107,15 +113,27 @@ goog.require('capnp.serialize');
   exports['writeMessageSegments'] = capnp.serialize.writeMessageSegments;
   exports['messageToFlatArray'] = capnp.serialize.messageToFlatArray;
   exports['InputStreamMessageReader'] = capnp.serialize.InputStreamMessageReader;
+  exports['StreamFramer'] = capnp.serialize.StreamFramer;
+  exports['readMessageStream'] = capnp.serialize.readMessageStream;
+  exports['buildMessageIndex'] = capnp.serialize.buildMessageIndex;
+  exports['writeMessageIndex'] = capnp.serialize.writeMessageIndex;
+  exports['readMessageIndex'] = capnp.serialize.readMessageIndex;
+  exports['MessageFileReader'] = capnp.serialize.MessageFileReader;
+  exports['MessageFrameIterator'] = capnp.serialize.MessageFrameIterator;
 
   exports['PackedInputStream'] = capnp.packed.PackedInputStream;
   exports['PackedOutputStream'] = capnp.packed.PackedOutputStream;
   exports['PackedMessageReader'] = capnp.packed.PackedMessageReader;
   exports['writePackedMessage'] = capnp.packed.writePackedMessage;
+  exports['packToArrayBuffer'] = capnp.packed.packToArrayBuffer;
+  exports['unpackFromArrayBuffer'] = capnp.packed.unpackFromArrayBuffer;
 
 
   goog.exportSymbol('MallocMessageBuilder', capnp.message.MallocMessageBuilder, exports);
   goog.exportSymbol('MallocMessageBuilder.prototype.initRoot', capnp.message.MallocMessageBuilder.prototype.initRoot, exports);
+  goog.exportSymbol('MallocMessageBuilder.prototype.reset', capnp.message.MallocMessageBuilder.prototype.reset, exports);
+  goog.exportSymbol('MallocMessageBuilder.prototype.dispose', capnp.message.MallocMessageBuilder.prototype.dispose, exports);
+  goog.exportSymbol('SegmentPool', capnp.message.SegmentPool, exports);
 
   goog.exportSymbol('StructBuilder', capnp.layout.StructBuilder, exports);
   goog.exportSymbol('StructBuilder.prototype.setDataField_bool', capnp.layout.StructBuilder.prototype.setDataField_bool, exports);
@@ -127,8 +145,20 @@ goog.require('capnp.serialize');
   goog.exportSymbol('StructBuilder.prototype.setDataField_uint16', capnp.layout.StructBuilder.prototype.setDataField_uint16, exports);
   goog.exportSymbol('StructBuilder.prototype.setDataField_uint32', capnp.layout.StructBuilder.prototype.setDataField_uint32, exports);
   goog.exportSymbol('StructBuilder.prototype.setDataField_uint64', capnp.layout.StructBuilder.prototype.setDataField_uint64, exports);
+  goog.exportSymbol('StructBuilder.prototype.setDataField_bigint64', capnp.layout.StructBuilder.prototype.setDataField_bigint64, exports);
+  goog.exportSymbol('StructBuilder.prototype.setDataField_biguint64', capnp.layout.StructBuilder.prototype.setDataField_biguint64, exports);
   goog.exportSymbol('StructBuilder.prototype.setDataField_float32', capnp.layout.StructBuilder.prototype.setDataField_float32, exports);
   goog.exportSymbol('StructBuilder.prototype.setDataField_float64', capnp.layout.StructBuilder.prototype.setDataField_float64, exports);
+  goog.exportSymbol('StructBuilder.prototype.setDataField_float32_masked', capnp.layout.StructBuilder.prototype.setDataField_float32_masked, exports);
+  goog.exportSymbol('StructBuilder.prototype.setDataField_float64_masked', capnp.layout.StructBuilder.prototype.setDataField_float64_masked, exports);
+
+  goog.exportSymbol('StreamFramer.prototype.push', capnp.serialize.StreamFramer.prototype.push, exports);
+  goog.exportSymbol('StreamFramer.prototype.end', capnp.serialize.StreamFramer.prototype.end, exports);
+  goog.exportSymbol('StreamFramer.prototype.next', capnp.serialize.StreamFramer.prototype.next, exports);
+  goog.exportSymbol('MessageFileReader.prototype.size', capnp.serialize.MessageFileReader.prototype.size, exports);
+  goog.exportSymbol('MessageFileReader.prototype.getIndex', capnp.serialize.MessageFileReader.prototype.getIndex, exports);
+  goog.exportSymbol('MessageFileReader.prototype.getMessage', capnp.serialize.MessageFileReader.prototype.getMessage, exports);
+  goog.exportSymbol('MessageFrameIterator.prototype.next', capnp.serialize.MessageFrameIterator.prototype.next, exports);
 
   goog.exportSymbol('Data', capnp.blob.Data, exports);
   goog.exportSymbol('Data.Reader', capnp.blob.Data.Reader, exports);
@@ -137,9 +167,14 @@ goog.require('capnp.serialize');
   goog.exportSymbol('Text', capnp.blob.Text, exports);
   goog.exportSymbol('Text.Reader', capnp.blob.Text.Reader, exports);
   goog.exportSymbol('Text.Builder', capnp.blob.Text.Builder, exports);
+  goog.exportSymbol('Text.Reader.prototype.str', capnp.blob.Text.Reader.prototype.str, exports);
+  goog.exportSymbol('Text.Reader.prototype.asUint8Array', capnp.blob.Text.Reader.prototype.asUint8Array, exports);
+  goog.exportSymbol('Text.Builder.prototype.str', capnp.blob.Text.Builder.prototype.str, exports);
+  goog.exportSymbol('Text.Builder.prototype.asUint8Array', capnp.blob.Text.Builder.prototype.asUint8Array, exports);
 
 
   exports['StringTextReader'] = capnp.blob.StringTextReader;
+  exports['copyDataBytes'] = capnp.blob.copyDataBytes;
 
   //goog.exportProperty(capnp.message.MallocMessageBuilder, 'initRoot', capnp.message.MallocMessageBuilder.initRoot);
 
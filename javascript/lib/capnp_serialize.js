@@ -26,7 +26,9 @@
 goog.provide('capnp.serialize');
 
 goog.require('capnp.message');
+goog.require('kj.debug');
 goog.require('kj.io');
+goog.require('kj.util');
 
 capnp.serialize.writeMessageSegments = function(output, arg) {
   var segments;
@@ -215,6 +217,630 @@ capnp.serialize.InputStreamMessageReader.prototype.toString = function() {
   return 'InputStreamMessageReader{...}';
 };
 
+/**
+ * Push-based framer for the standard stream format, for input that arrives in
+ * arbitrary chunks (e.g. from a socket or pipe).  Feed it with push(); every
+ * complete message is passed to onMessage as a MessageReader or, if no
+ * callback was given, queued for consumption through the async iterator.
+ *
+ * Segments which lie entirely within a single chunk are returned as DataViews
+ * over that chunk without copying, so chunks must not be modified after they
+ * have been pushed.  Only segments spanning chunk boundaries are copied.
+ *
+ * When messages are queued for the iterator, pauseSource and resumeSource (if
+ * set) are called as the queue fills past options.highWaterMark messages and
+ * drains again, so that the producer can stop reading meanwhile.
+ *
+ * @constructor
+ * @param {?function(capnp.message.MessageReader)=} onMessage
+ * @param {Object=} options
+ */
+capnp.serialize.StreamFramer = function(onMessage, options) {
+
+  this.onMessage = onMessage || null;
+  this.options = options;
+  this.traversalLimitInWords = (options && options.traversalLimitInWords) || capnp.message.DEFAULT_READER_OPTIONS.traversalLimitInWords;
+
+  // Buffered input.  chunks[0] always has unconsumed data starting at chunkOffset.
+  this.chunks = [];
+  this.chunkOffset = 0;
+  this.buffered = 0;
+
+  // Sizes in words of the message currently being read, once its segment table is complete.
+  this.segmentSizes = null;
+  this.totalWords = 0;
+
+  // Messages not yet consumed by the iterator are queue[queueHead..].
+  this.queue = [];
+  this.queueHead = 0;
+  this.highWaterMark = (options && options.highWaterMark) || 16;
+  this.pauseSource = null;
+  this.resumeSource = null;
+  this.sourcePaused = false;
+
+  this.waiting = [];
+  this.ended = false;
+  this.error = null;
+};
+
+/**
+ * @param {ArrayBuffer|Uint8Array} chunk
+ */
+capnp.serialize.StreamFramer.prototype.push = function(chunk) {
+
+  kj.debug.REQUIRE(!this.ended, 'StreamFramer.push() called after end().');
+  kj.debug.REQUIRE(this.error === null, 'StreamFramer.push() called after failure.');
+
+  if (kj.util.isArrayBuffer(chunk)) {
+    chunk = new Uint8Array(chunk);
+  }
+  if (chunk.byteLength === 0) {
+    return;
+  }
+
+  this.chunks.push(chunk);
+  this.buffered += chunk.byteLength;
+
+  try {
+    while (this._tryReadMessage()) {}
+  }
+  catch (e) {
+    // The stream can't be resynchronized after a framing error.
+    this.fail(e);
+    throw e;
+  }
+};
+
+/**
+ * Signals the end of input.  Throws if a partial message is still buffered.
+ */
+capnp.serialize.StreamFramer.prototype.end = function() {
+
+  this.ended = true;
+
+  if (this.buffered !== 0 || this.segmentSizes !== null) {
+    this.fail(new Error('Premature EOF.'));
+    kj.debug.REQUIRE(false, 'Premature EOF.');
+  }
+
+  var waiting = this.waiting;
+  this.waiting = [];
+  for (var i = 0, len = waiting.length; i < len; ++i) {
+    waiting[i].resolve({ value: undefined, done: true });
+  }
+};
+
+/**
+ * Aborts reading; pending and future iterator calls reject with error.
+ */
+capnp.serialize.StreamFramer.prototype.fail = function(error) {
+
+  if (this.error !== null) {
+    return;
+  }
+  this.error = error;
+
+  var waiting = this.waiting;
+  this.waiting = [];
+  for (var i = 0, len = waiting.length; i < len; ++i) {
+    waiting[i].reject(error);
+  }
+};
+
+capnp.serialize.StreamFramer.prototype.next = function() {
+
+  if (this.queueHead < this.queue.length) {
+    return Promise.resolve({ value: this._dequeue(), done: false });
+  }
+  else if (this.error !== null) {
+    return Promise.reject(this.error);
+  }
+  else if (this.ended) {
+    return Promise.resolve({ value: undefined, done: true });
+  }
+
+  var waiting = this.waiting;
+  return new Promise(function(resolve, reject) {
+    waiting.push({ resolve: resolve, reject: reject });
+  });
+};
+
+if (typeof Symbol !== 'undefined' && Symbol.asyncIterator) {
+  capnp.serialize.StreamFramer.prototype[Symbol.asyncIterator] = function() {
+    return this;
+  };
+}
+
+capnp.serialize.StreamFramer.prototype.toString = function() {
+  return 'StreamFramer{buffered=' + this.buffered + '}';
+};
+
+capnp.serialize.StreamFramer.prototype._emit = function(reader) {
+
+  if (this.onMessage !== null) {
+    this.onMessage(reader);
+  }
+  else if (this.waiting.length > 0) {
+    this.waiting.shift().resolve({ value: reader, done: false });
+  }
+  else {
+    this.queue.push(reader);
+    if (!this.sourcePaused && this.pauseSource !== null &&
+        this.queue.length - this.queueHead >= this.highWaterMark) {
+      this.sourcePaused = true;
+      this.pauseSource();
+    }
+  }
+};
+
+capnp.serialize.StreamFramer.prototype._dequeue = function() {
+
+  var reader = this.queue[this.queueHead];
+  this.queue[this.queueHead++] = null;
+
+  // Drop consumed entries once they make up most of the array, so that dequeuing stays
+  // amortized O(1) without the array growing forever.
+  if (this.queueHead === this.queue.length) {
+    this.queue.length = 0;
+    this.queueHead = 0;
+  }
+  else if (this.queueHead >= 1024 && this.queueHead * 2 >= this.queue.length) {
+    this.queue = this.queue.slice(this.queueHead);
+    this.queueHead = 0;
+  }
+
+  if (this.sourcePaused && this.queue.length - this.queueHead < this.highWaterMark) {
+    this.sourcePaused = false;
+    if (this.resumeSource !== null) {
+      this.resumeSource();
+    }
+  }
+
+  return reader;
+};
+
+capnp.serialize.StreamFramer.prototype._tryReadMessage = function() {
+
+  if (this.segmentSizes === null) {
+
+    if (this.buffered < 8) {
+      return false;
+    }
+
+    var segmentCount = this._peekUint32(0) + 1;
+
+    // Reject messages with too many segments for security reasons.
+    kj.debug.REQUIRE(segmentCount < 512, 'Message has too many segments.');
+
+    // The segment table, including padding if necessary.
+    var tableBytes = ((segmentCount >>> 1) + 1) << 3;
+    if (this.buffered < tableBytes) {
+      return false;
+    }
+
+    var segmentSizes = [];
+    var totalWords = 0;
+    for (var i = 0; i < segmentCount; ++i) {
+      segmentSizes[i] = this._peekUint32((i + 1) << 2);
+      totalWords += segmentSizes[i];
+    }
+
+    // Don't accept a message which the receiver couldn't possibly traverse without hitting the
+    // traversal limit.  Without this check, a malicious client could transmit a very large segment
+    // size to make the receiver buffer excessive amounts of data.
+    kj.debug.REQUIRE(totalWords <= this.traversalLimitInWords,
+                     'Message is too large.  To increase the limit on the receiving end, see capnp::ReaderOptions.');
+
+    this._skip(tableBytes);
+    this.segmentSizes = segmentSizes;
+    this.totalWords = totalWords;
+  }
+
+  if (this.buffered < this.totalWords * 8) {
+    return false;
+  }
+
+  var segments = [];
+  for (var i = 0, len = this.segmentSizes.length; i < len; ++i) {
+    segments.push(this._takeSegment(this.segmentSizes[i] * 8));
+  }
+  this.segmentSizes = null;
+  this.totalWords = 0;
+
+  this._emit(new capnp.message.SegmentArrayMessageReader(segments, this.options));
+  return true;
+};
+
+capnp.serialize.StreamFramer.prototype._peekUint32 = function(byteOffset) {
+
+  var chunkIndex = 0;
+  var pos = this.chunkOffset + byteOffset;
+  while (pos >= this.chunks[chunkIndex].byteLength) {
+    pos -= this.chunks[chunkIndex].byteLength;
+    ++chunkIndex;
+  }
+
+  var result = 0;
+  for (var shift = 0; shift < 32; shift += 8) {
+    var chunk = this.chunks[chunkIndex];
+    result += chunk[pos] * Math.pow(2, shift);
+    if (++pos === chunk.byteLength) {
+      pos = 0;
+      ++chunkIndex;
+    }
+  }
+  return result;
+};
+
+capnp.serialize.StreamFramer.prototype._skip = function(byteLength) {
+
+  this.buffered -= byteLength;
+  this.chunkOffset += byteLength;
+  while (this.chunks.length > 0 && this.chunkOffset >= this.chunks[0].byteLength) {
+    this.chunkOffset -= this.chunks[0].byteLength;
+    this.chunks.shift();
+  }
+};
+
+capnp.serialize.StreamFramer.prototype._takeSegment = function(byteLength) {
+
+  if (byteLength === 0) {
+    return new DataView(new ArrayBuffer(0));
+  }
+
+  var chunk = this.chunks[0];
+  var result;
+
+  if (this.chunkOffset + byteLength <= chunk.byteLength) {
+    // Fast path: the segment lies within a single chunk.
+    result = new DataView(chunk.buffer, chunk.byteOffset + this.chunkOffset, byteLength);
+    this._skip(byteLength);
+    return result;
+  }
+
+  // The segment spans chunks, so it has to be copied into contiguous memory.
+  var copy = new Uint8Array(byteLength);
+  var pos = 0;
+  while (pos < byteLength) {
+    chunk = this.chunks[0];
+    var amount = Math.min(byteLength - pos, chunk.byteLength - this.chunkOffset);
+    copy.set(chunk.subarray(this.chunkOffset, this.chunkOffset + amount), pos);
+    pos += amount;
+    this._skip(amount);
+  }
+  return new DataView(copy.buffer);
+};
+
+/**
+ * Feeds a Node.js Readable stream into a new StreamFramer.  Iterate over the
+ * result with for-await, or pass onMessage to receive messages as they arrive.
+ * The stream is paused while options.highWaterMark (default 16) messages are
+ * waiting for the iterator.
+ *
+ * Framing errors, premature EOF and errors of the stream itself make the
+ * iterator reject, and are passed to onError if given.  Pass onError along
+ * with onMessage, or they go unnoticed.
+ *
+ * @param {Object} stream
+ * @param {Object=} options
+ * @param {?function(capnp.message.MessageReader)=} onMessage
+ * @param {?function(*)=} onError
+ * @return {capnp.serialize.StreamFramer}
+ */
+capnp.serialize.readMessageStream = function(stream, options, onMessage, onError) {
+
+  var framer = new capnp.serialize.StreamFramer(onMessage, options);
+
+  var report = function(e) {
+    framer.fail(e);
+    if (onError) {
+      onError(e);
+    }
+  };
+
+  // Stop reading while the iterator falls behind.
+  framer.pauseSource = function() { stream.pause(); };
+  framer.resumeSource = function() { stream.resume(); };
+
+  stream.on('data', function(chunk) {
+    try {
+      framer.push(chunk);
+    }
+    catch (e) {
+      // Reported through the stream's 'error' event.
+      stream.destroy(e);
+    }
+  });
+  stream.on('end', function() {
+    try {
+      framer.end();
+    }
+    catch (e) {
+      report(e);
+    }
+  });
+  stream.on('error', report);
+
+  return framer;
+};
+
+/**
+ * Parses the segment table of the message framed at word wordOffset of view,
+ * checks that the whole message lies within view and returns the word offset
+ * just past it.  If segments is given, DataViews over the message segments are
+ * appended to it.
+ */
+var readFrame = function(view, wordOffset, traversalLimitInWords, segments) {
+
+  var wordLength = Math.floor(view.byteLength / 8);
+  var byteOffset = wordOffset * 8;
+
+  kj.debug.REQUIRE(wordOffset < wordLength, 'Message ends prematurely in segment table.');
+
+  var segmentCount = view.getUint32(byteOffset, true) + 1;
+
+  // Reject messages with too many segments for security reasons.
+  kj.debug.REQUIRE(segmentCount < 512, 'Message has too many segments.');
+
+  // The segment table, including padding if necessary.
+  var tableWords = (segmentCount >>> 1) + 1;
+  kj.debug.REQUIRE(wordOffset + tableWords <= wordLength, 'Message ends prematurely in segment table.');
+
+  var totalWords = 0;
+  for (var i = 0; i < segmentCount; ++i) {
+    totalWords += view.getUint32(byteOffset + ((i + 1) << 2), true);
+  }
+
+  kj.debug.REQUIRE(totalWords <= traversalLimitInWords,
+                   'Message is too large.  To increase the limit on the receiving end, see capnp::ReaderOptions.');
+
+  var end = wordOffset + tableWords + totalWords;
+  kj.debug.REQUIRE(end <= wordLength, 'Message ends prematurely.');
+
+  if (segments) {
+    var pos = view.byteOffset + (wordOffset + tableWords) * 8;
+    for (var i = 0; i < segmentCount; ++i) {
+      var segmentSize = view.getUint32(byteOffset + ((i + 1) << 2), true) * 8;
+      segments.push(new DataView(view.buffer, pos, segmentSize));
+      pos += segmentSize;
+    }
+  }
+
+  return end;
+};
+
+/**
+ * Returns a DataView over data, which holds zero or more messages in the
+ * standard stream format back to back (e.g. as written by repeated calls to
+ * writeMessageSegments).
+ */
+var messageFileView = function(data) {
+
+  var view;
+  if (kj.util.isArrayBuffer(data)) {
+    view = new DataView(data);
+  }
+  else {
+    kj.debug.REQUIRE(ArrayBuffer.isView(data), 'expected ArrayBuffer or ArrayBufferView but got ' + data);
+    view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+  }
+
+  kj.debug.REQUIRE(view.byteLength % 8 === 0, 'Message file size is not a multiple of the word size.');
+  kj.debug.REQUIRE(view.byteLength / 8 <= 0xffffffff, 'Message file is too large to be indexed.');
+  return view;
+};
+
+var traversalLimitOf = function(options) {
+  return (options && options.traversalLimitInWords) || capnp.message.DEFAULT_READER_OPTIONS.traversalLimitInWords;
+};
+
+/**
+ * Scans the segment tables of all messages in data, skipping over their
+ * content, and returns the word offset of each message followed by the word
+ * length of data.  Message i thus spans words index[i] to index[i + 1].
+ *
+ * @param {ArrayBuffer|ArrayBufferView} data
+ * @param {Object=} options
+ * @return {Uint32Array}
+ */
+capnp.serialize.buildMessageIndex = function(data, options) {
+
+  var view = messageFileView(data);
+  var wordLength = view.byteLength / 8;
+  var traversalLimitInWords = traversalLimitOf(options);
+
+  var index = new Uint32Array(64);
+  var count = 0;
+  var wordOffset = 0;
+
+  for (;;) {
+    if (count === index.length) {
+      var grown = new Uint32Array(count * 2);
+      grown.set(index);
+      index = grown;
+    }
+    index[count++] = wordOffset;
+    if (wordOffset === wordLength) {
+      break;
+    }
+    wordOffset = readFrame(view, wordOffset, traversalLimitInWords, null);
+  }
+
+  return index.slice(0, count);
+};
+
+/**
+ * Serializes an index returned by buildMessageIndex for storage next to the
+ * message file, as little-endian 32-bit word offsets.
+ *
+ * @param {Uint32Array} index
+ * @return {ArrayBuffer}
+ */
+capnp.serialize.writeMessageIndex = function(index) {
+
+  var buffer = new ArrayBuffer(index.length * 4);
+  var view = new DataView(buffer);
+  for (var i = 0, len = index.length; i < len; ++i) {
+    view.setUint32(i << 2, index[i], true);
+  }
+  return buffer;
+};
+
+/**
+ * Checks that index, as returned by buildMessageIndex, is sorted and spans
+ * exactly the messages in view.
+ */
+var checkMessageIndex = function(index, view) {
+
+  kj.debug.REQUIRE(index.length >= 1, 'Invalid message index size.');
+  for (var i = 1, len = index.length; i < len; ++i) {
+    kj.debug.REQUIRE(index[i] > index[i - 1], 'Message index is not sorted.');
+  }
+  kj.debug.REQUIRE(index[0] === 0 && index[index.length - 1] === view.byteLength / 8,
+                   'Message index does not match message file.');
+};
+
+/**
+ * Deserializes an index written by writeMessageIndex, checking that it is
+ * consistent with data.  The messages themselves are not looked at; their
+ * segment tables are checked against the index as they are read.
+ *
+ * @param {ArrayBuffer|ArrayBufferView} bytes
+ * @param {ArrayBuffer|ArrayBufferView} data
+ * @return {Uint32Array}
+ */
+capnp.serialize.readMessageIndex = function(bytes, data) {
+
+  var view = kj.util.isArrayBuffer(bytes) ? new DataView(bytes) : new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  kj.debug.REQUIRE(view.byteLength >= 4 && view.byteLength % 4 === 0, 'Invalid message index size.');
+
+  var index = new Uint32Array(view.byteLength >>> 2);
+  for (var i = 0, len = index.length; i < len; ++i) {
+    index[i] = view.getUint32(i << 2, true);
+  }
+
+  checkMessageIndex(index, messageFileView(data));
+  return index;
+};
+
+/**
+ * Random access to the messages in a buffer holding many messages in the
+ * standard stream format back to back.  The message boundaries are found by a
+ * single scan over the segment tables, unless an index built earlier by
+ * buildMessageIndex (or loaded from a file written with writeMessageIndex) is
+ * passed in.  Messages are returned as readers over data without copying.
+ *
+ * @constructor
+ * @param {ArrayBuffer|ArrayBufferView} data
+ * @param {Object=} options
+ * @param {Uint32Array|ArrayBuffer=} index
+ */
+capnp.serialize.MessageFileReader = function(data, options, index) {
+
+  this.view = messageFileView(data);
+  this.options = options;
+  this.traversalLimitInWords = traversalLimitOf(options);
+
+  if (!index) {
+    index = capnp.serialize.buildMessageIndex(this.view, options);
+  }
+  else if (index instanceof Uint32Array) {
+    checkMessageIndex(index, this.view);
+  }
+  else {
+    index = capnp.serialize.readMessageIndex(index, this.view);
+  }
+  this.index = index;
+};
+
+/**
+ * @return {number} the number of messages.
+ */
+capnp.serialize.MessageFileReader.prototype.size = function() {
+  return this.index.length - 1;
+};
+
+/**
+ * @return {Uint32Array} the word offsets of the messages, see buildMessageIndex.
+ */
+capnp.serialize.MessageFileReader.prototype.getIndex = function() {
+  return this.index;
+};
+
+/**
+ * @param {number} i
+ * @return {capnp.message.MessageReader}
+ */
+capnp.serialize.MessageFileReader.prototype.getMessage = function(i) {
+
+  kj.debug.REQUIRE(i >= 0 && i < this.index.length - 1, 'Message index out of bounds: ' + i);
+
+  var segments = [];
+  var end = readFrame(this.view, this.index[i], this.traversalLimitInWords, segments);
+  kj.debug.REQUIRE(end === this.index[i + 1], 'Message index does not match message file.');
+  return new capnp.message.SegmentArrayMessageReader(segments, this.options);
+};
+
+capnp.serialize.MessageFileReader.prototype.toString = function() {
+  return 'MessageFileReader{size=' + this.size() + '}';
+};
+
+if (typeof Symbol !== 'undefined' && Symbol.iterator) {
+  capnp.serialize.MessageFileReader.prototype[Symbol.iterator] = function() {
+    var self = this;
+    var i = 0;
+    return {
+      next: function() {
+        if (i < self.size()) {
+          return { value: self.getMessage(i++), done: false };
+        }
+        return { value: undefined, done: true };
+      }
+    };
+  };
+}
+
+/**
+ * Walks the messages in a buffer holding many messages in the standard stream
+ * format back to back, without building an index.  Each call to next()
+ * returns a reader over the next message without copying.  wordOffset is the
+ * position of the next message, which can be saved and passed back in to
+ * resume later.
+ *
+ * @constructor
+ * @param {ArrayBuffer|ArrayBufferView} data
+ * @param {Object=} options
+ * @param {number=} wordOffset
+ */
+capnp.serialize.MessageFrameIterator = function(data, options, wordOffset) {
+
+  this.view = messageFileView(data);
+  this.options = options;
+  this.traversalLimitInWords = traversalLimitOf(options);
+  this.wordOffset = wordOffset || 0;
+};
+
+capnp.serialize.MessageFrameIterator.prototype.next = function() {
+
+  if (this.wordOffset === this.view.byteLength / 8) {
+    return { value: undefined, done: true };
+  }
+
+  var segments = [];
+  this.wordOffset = readFrame(this.view, this.wordOffset, this.traversalLimitInWords, segments);
+  return { value: new capnp.message.SegmentArrayMessageReader(segments, this.options), done: false };
+};
+
+capnp.serialize.MessageFrameIterator.prototype.toString = function() {
+  return 'MessageFrameIterator{wordOffset=' + this.wordOffset + '}';
+};
+
+if (typeof Symbol !== 'undefined' && Symbol.iterator) {
+  capnp.serialize.MessageFrameIterator.prototype[Symbol.iterator] = function() {
+    return this;
+  };
+}
+
 // var fs = require('fs');
 
 // /**
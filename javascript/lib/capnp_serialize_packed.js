@@ -32,399 +32,422 @@ goog.require('goog.asserts');
 goog.require('capnp.common');
 goog.require('capnp.serialize');
 
+// Packing works on whole words.  A word's tag has bit n set iff byte n of the word is nonzero.
+// TAG_POPCOUNT gives the number of nonzero bytes for each tag, TAG_OFFSETS (eight entries per
+// tag) their offsets within the word, in order.
+
+/** @const */ var TAG_POPCOUNT = new Uint8Array(256);
+/** @const */ var TAG_OFFSETS = new Uint8Array(256 * 8);
+
+(function() {
+  for (var tag = 0; tag < 256; ++tag) {
+    var count = 0;
+    for (var i = 0; i < 8; ++i) {
+      if (tag & (1 << i)) {
+        TAG_OFFSETS[(tag << 3) + count++] = i;
+      }
+    }
+    TAG_POPCOUNT[tag] = count;
+  }
+})();
+
 /**
- * @constructor
+ * @param {number} x A 32-bit half word, little-endian.
+ * @return {number} The low or high nibble of the tag for x.
  */
-capnp.packed.PackedOutputStream = function(inner) {
-  kj.io.OutputStream.call(this);
-  this.inner = inner;
+var tagNibble = function(x) {
+  // Set the high bit of each byte of m iff the corresponding byte of x is nonzero, then gather
+  // those four bits.
+  var m = (((x & 0x7f7f7f7f) + 0x7f7f7f7f) | x) & 0x80808080;
+  return ((m >>> 7) & 1) | ((m >>> 14) & 2) | ((m >>> 21) & 4) | ((m >>> 28) & 8);
 };
-capnp.packed.PackedOutputStream.prototype = Object.create(kj.io.OutputStream.prototype);
-capnp.packed.PackedOutputStream.prototype.constructor = capnp.packed.PackedOutputStream;
-capnp.packed.PackedOutputStream.prototype.write = function(src, offset, size) {
 
-  goog.asserts.assert(kj.util.isArrayBuffer(src), 'PackedOutputStream.write requires ArrayBuffer as first argument');
-  goog.asserts.assert(kj.util.isRegularNumber(offset), 'PackedOutputStream.write requires numeric offset as second argument');
-  goog.asserts.assert(kj.util.isRegularNumber(size), 'PackedOutputStream.write requires numeric size as third argument');
-  goog.asserts.assert(offset + size <= src.byteLength, 'PackedOutputStream.write asked to access buffer beyond end; byteLength=' + src.byteLength + ', offset=' + offset + ', size=' + size);
-
-  var buffer = this.inner.getWriteBuffer();
-  var slowBuffer = new ArrayBuffer(20);
-
-  var inArray = new Uint8Array(src, offset, size);
-
-  var inPos = 0;
-  var outPos = 0;
-
-  while (inPos < size) {
+/**
+ * @param {number} byteLength Size of the unpacked input, a multiple of the word size.
+ * @return {number} An upper bound for the size of the packed output.
+ */
+capnp.packed.maxPackedSize = function(byteLength) {
+  // Worst case is a run of words with no zeros at all: tag, eight bytes and count for the first,
+  // eight bytes for each further word.  So never more than ten bytes per word.
+  return byteLength + (byteLength >>> 2);
+};
 
-    if (buffer.byteLength - outPos < 10) {
-      // Oops, we're out of space.  We need at least 10 bytes for the fast path, since we don't
-      // bounds-check on every byte.
+/**
+ * Packs the words in src[srcPos, srcEnd) into dst starting at dstPos.  dst must have room for
+ * at least maxPackedSize(srcEnd - srcPos) bytes.
+ *
+ * @param {Uint8Array} src
+ * @param {number} srcPos
+ * @param {number} srcEnd
+ * @param {Uint8Array} dst
+ * @param {number} dstPos
+ * @return {number} The end position of the output within dst.
+ */
+capnp.packed.packWords = function(src, srcPos, srcEnd, dst, dstPos) {
 
-      // Write what we have so far.
-      this.inner.write(buffer, 0, outPos);
+  kj.debug.DREQUIRE((srcEnd - srcPos) % capnp.common.BYTES_PER_WORD === 0,
+                    'Packed output must be word-aligned: ' + (srcEnd - srcPos));
 
-      // Use a slow buffer into which we'll encode 10 to 20 bytes.  This should get us past the
-      // output stream's buffer boundary.
-      outPos = 0;
-    }
+  var view = new DataView(src.buffer, src.byteOffset, src.byteLength);
 
-    var tagPos = outPos++;
+  while (srcPos < srcEnd) {
 
-    var tag = 0;
-    for (var j = 0; j < 8; ++j) {
-      var bit = inArray[inPos] != 0;
-      buffer[outPos] = inArray[inPos];
-      outPos += bit;
-      ++inPos;
-      tag |= bit << j;
-    }
+    var lo = view.getUint32(srcPos, true);
+    var hi = view.getUint32(srcPos + 4, true);
+    var tag = tagNibble(lo) | (tagNibble(hi) << 4);
 
-    buffer[tagPos] = tag;
+    dst[dstPos++] = tag;
 
     if (tag === 0) {
       // An all-zero word is followed by a count of consecutive zero words (not including the
-      // first one).
-
-      // We can check a whole word at a time.
-      var inLong = new Uint32Array(src);
-      var inLongPos = inPos >>> 3;
-
-      // The count must fit it 1 byte, so limit to 255 words.
-      var limit = size >>> 3;
-      if (limit - inLongPos > 255) {
-        limit = inLongPos + 255;
+      // first one).  The count must fit in 1 byte, so limit to 255 words.
+      srcPos += 8;
+      var runStart = srcPos;
+      var limit = Math.min(srcEnd, srcPos + 255 * capnp.common.BYTES_PER_WORD);
+      while (srcPos < limit && view.getUint32(srcPos, true) === 0 && view.getUint32(srcPos + 4, true) === 0) {
+        srcPos += 8;
       }
-
-      while (inLongPos < limit && inLong[inLongPos * 2 + 0] === 0 && inLong[inLongPos * 2 + 1] === 0) {
-        ++inLongPos;
-      }
-
-      // Write the count.
-      buffer[outPos++] = inLongPos - (inPos >>> 3);
-
-      // Advance input.
-      inPos = inLongPos << 3;
+      dst[dstPos++] = (srcPos - runStart) >>> 3;
 
     } else if (tag === 0xff) {
-
       // An all-nonzero word is followed by a count of consecutive uncompressed words, followed
       // by the uncompressed words themselves.
+      for (var i = 0; i < 8; ++i) {
+        dst[dstPos++] = src[srcPos++];
+      }
 
       // Count the number of consecutive words in the input which have no more than a single
       // zero-byte.  We look for at least two zeros because that's the point where our compression
       // scheme becomes a net win.
-      // TODO(perf):  Maybe look for three zeros?  Compressing a two-zero word is a loss if the
-      //   following word has no zeros.
-      var runStartPos = inPos;
-
-      var limitPos = size;
-      if (limitPos - inPos > 255 * capnp.common.BYTES_PER_WORD) {
-        limitPos = inPos + 255 * capnp.common.BYTES_PER_WORD;
-      }
-
-      while (inPos < limitPos) {
-        // Check eight input bytes for zeros.
-        var c = inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-        c += inArray[inPos++] === 0;
-
-        if (c >= 2) {
-          // Un-read the word with multiple zeros, since we'll want to compress that one.
-          inPos -= 8;
+      var runStart = srcPos;
+      var limit = Math.min(srcEnd, srcPos + 255 * capnp.common.BYTES_PER_WORD);
+      while (srcPos < limit) {
+        var runTag = tagNibble(view.getUint32(srcPos, true)) | (tagNibble(view.getUint32(srcPos + 4, true)) << 4);
+        if (TAG_POPCOUNT[runTag] < 7) {
           break;
         }
+        srcPos += 8;
       }
 
-      // Write the count.
-      var count = inPos - runStartPos;
-
-      buffer[outPos++] = count / 8;
-
-      if (count <= buffer.byteLength - outPos) {
-        // There's enough space to memcpy.
-        buffer.set(inArray.subarray(runStartPos, runStartPos + count), outPos);
-        outPos += count;
-      } else {
-        // Input overruns the output buffer.  We'll give it to the output stream in one chunk
-        // and let it decide what to do.
-        this.inner.write(buffer, 0, outPos);
-        this.inner.write(runStartPos, 0, inPos - runStartPos);
-        buffer = this.inner.getWriteBuffer();
-        outPos = 0;
+      var count = srcPos - runStart;
+      dst[dstPos++] = count >>> 3;
+      if (count > 0) {
+        dst.set(src.subarray(runStart, srcPos), dstPos);
+        dstPos += count;
       }
+
+    } else {
+      var base = tag << 3;
+      for (var i = 0, n = TAG_POPCOUNT[tag]; i < n; ++i) {
+        dst[dstPos++] = src[srcPos + TAG_OFFSETS[base + i]];
+      }
+      srcPos += 8;
     }
   }
 
-  // Write whatever is left.
-  this.inner.write(buffer, 0, outPos);
+  return dstPos;
 };
 
 /**
- * @constructor
+ * Unpacks complete tag groups from src[cursor.inPos, srcEnd) into dst[dstPos, dstEnd), stopping
+ * early before a group that isn't entirely contained in src.  The uncompressed tail of a 0xff
+ * group may be split; what is left of it is kept in cursor.pendingRun.  If dst is null the data
+ * is skipped, and if cursor.dstZeroed is set zero bytes aren't written.
+ *
+ * @param {{inPos: number, pendingRun: number, dstZeroed: boolean}} cursor
+ * @param {Uint8Array} src
+ * @param {number} srcEnd
+ * @param {Uint8Array} dst
+ * @param {number} dstPos
+ * @param {number} dstEnd
+ * @return {number} The new output position.
  */
-capnp.packed.PackedInputStream = function(inner) {
-  kj.io.InputStream.call(this);
-  this.inner = inner;
-};
-capnp.packed.PackedInputStream.prototype = Object.create(kj.io.InputStream.prototype);
-capnp.packed.PackedInputStream.prototype.constructor = capnp.packed.PackedInputStream;
-capnp.packed.PackedInputStream.prototype.tryRead = function(dst, offset, minBytes, maxBytes) {
+var unpackGroups = function(cursor, src, srcEnd, dst, dstPos, dstEnd) {
 
-  if (maxBytes === 0) {
-    return 0;
-  }
-
-  kj.debug.DREQUIRE(minBytes % capnp.common.BYTES_PER_WORD === 0, 'PackedInputStream reads must be word-aligned: ' + minBytes);
-  kj.debug.DREQUIRE(maxBytes % capnp.common.BYTES_PER_WORD === 0, 'PackedInputStream reads must be word-aligned: ' + maxBytes);
-
-  var outPos = offset;
-  var outEnd = offset + maxBytes;
-  var outMin = offset + minBytes;
-  var outArray = new Uint8Array(dst);
-
-  var buffer = this.inner.getReadBuffer();
-  if (buffer.byteLength === 0) {
-    return 0;
-  }
-  var inPos = 0;
-  var inArray = new Uint8Array(buffer);
-
-  var self = this;
-  var REFRESH_BUFFER = function() {
-    self.inner.skip(buffer.byteLength);
-    buffer = self.inner.getReadBuffer();
-    inArray = new Uint8Array(buffer);
-    kj.debug.REQUIRE(buffer.byteLength > 0, 'Premature end of packed input.');
-    inPos = 0;
-  };
-
-  var BUFFER_END = function() { return buffer.byteLength; };
-  var BUFFER_REMAINING = function() { return BUFFER_END() - inPos; };
+  var srcPos = cursor.inPos;
+  var zeroed = cursor.dstZeroed;
 
   for (;;) {
-    var tag;
-
-    kj.debug.DASSERT(outPos % capnp.common.BYTES_PER_WORD === 0,
-                     'Output pointer should always be aligned here.');
 
-    if (BUFFER_REMAINING() < 10) {
-
-      if (outPos >= outMin) {
-        // We read at least the minimum amount, so go ahead and return.
-        this.inner.skip(inPos);
-        return outPos - offset;
+    if (cursor.pendingRun > 0) {
+      var amount = Math.min(cursor.pendingRun, srcEnd - srcPos);
+      if (amount === 0) {
+        break;
       }
-
-      if (BUFFER_REMAINING() === 0) {
-        REFRESH_BUFFER();
-        continue;
+      if (dst !== null) {
+        dst.set(src.subarray(srcPos, srcPos + amount), dstPos);
       }
+      srcPos += amount;
+      dstPos += amount;
+      cursor.pendingRun -= amount;
+      continue;
+    }
 
-      // We have at least 1, but not 10, bytes available.  We need to read slowly, doing a bounds
-      // check on each byte.
+    if (srcPos === srcEnd || dstPos === dstEnd) {
+      break;
+    }
 
-      tag = inArray[inPos++];
+    var tag = src[srcPos];
+    var count = TAG_POPCOUNT[tag];
+    if (srcPos + 1 + count + (tag === 0 || tag === 0xff ? 1 : 0) > srcEnd) {
+      break;
+    }
 
-      for (var i = 0; i < 8; i++) {
-        if (tag & (1 << i)) {
-          if (BUFFER_REMAINING() === 0) {
-            REFRESH_BUFFER();
-          }
-          outArray[outPos++] = inArray[inPos++];
-        } else {
-          outArray[outPos++] = 0;
-        }
+    ++srcPos;
+    if (dst !== null) {
+      if (!zeroed) {
+        dst[dstPos] = 0; dst[dstPos + 1] = 0; dst[dstPos + 2] = 0; dst[dstPos + 3] = 0;
+        dst[dstPos + 4] = 0; dst[dstPos + 5] = 0; dst[dstPos + 6] = 0; dst[dstPos + 7] = 0;
       }
-
-      if (BUFFER_REMAINING() === 0 && (tag === 0 || tag === 0xff)) {
-        REFRESH_BUFFER();
-      }
-    } else {
-
-      tag = inArray[inPos++];
-
-      for (var n = 0; n < 8; ++n) {
-        var isNonzero = (tag & (1 << n)) != 0;
-        outArray[outPos++] = inArray[inPos] & (isNonzero ? 0xff : 0x00);
-        inPos += isNonzero;
+      var base = tag << 3;
+      for (var i = 0; i < count; ++i) {
+        dst[dstPos + TAG_OFFSETS[base + i]] = src[srcPos + i];
       }
     }
+    srcPos += count;
+    dstPos += 8;
 
     if (tag === 0) {
-      kj.debug.DASSERT(BUFFER_REMAINING() > 0, 'Should always have non-empty buffer here.');
+      var runLength = src[srcPos++] * capnp.common.BYTES_PER_WORD;
 
-      var runLength = inArray[inPos++] * capnp.common.BYTES_PER_WORD;
-
-      kj.debug.REQUIRE(runLength <= outEnd - outPos,
+      kj.debug.REQUIRE(runLength <= dstEnd - dstPos,
                        'Packed input did not end cleanly on a segment boundary.');
-      for (var i = 0; i < runLength; ++i) {
-        outArray[outPos + i] = 0;
+
+      if (dst !== null && !zeroed) {
+        dst.fill(0, dstPos, dstPos + runLength);
       }
-      outPos += runLength;
+      dstPos += runLength;
 
     } else if (tag === 0xff) {
-      kj.debug.DASSERT(BUFFER_REMAINING() > 0, 'Should always have non-empty buffer here.');
+      var runLength = src[srcPos++] * capnp.common.BYTES_PER_WORD;
 
-      var runLength = inArray[inPos++] * capnp.common.BYTES_PER_WORD;
-
-      kj.debug.REQUIRE(runLength <= outEnd - outPos,
+      kj.debug.REQUIRE(runLength <= dstEnd - dstPos,
                        'Packed input did not end cleanly on a segment boundary.');
 
-      var inRemaining = BUFFER_REMAINING();
-      if (inRemaining >= runLength) {
-        // Fast path.
-        outArray.set(inArray.subarray(inPos, inPos + runLength), outPos);
-        outPos += runLength;
-        inPos += runLength;
-      } else {
-        // Copy over the first buffer, then do one big read for the rest.
-        outArray.set(inArray.subarray(inPos, inPos + inRemaining), outPos);
-        outPos += inRemaining;
-        runLength -= inRemaining;
-
-        this.inner.skip(buffer.byteLength);
-        this.inner.read(dst, outPos, runLength);
-        outPos += runLength;
-
-        if (outPos === outEnd) {
-          return maxBytes;
-        } else {
-          buffer = this.inner.getReadBuffer();
-          inArray = new Uint8Array(buffer);
-          inPos = 0;
-
-          // Skip the bounds check below since we just did the same check above.
-          continue;
-        }
-      }
-    }
-
-    if (outPos === outEnd) {
-      this.inner.skip(inPos);
-      return maxBytes;
+      cursor.pendingRun = runLength;
     }
   }
 
-  kj.debug.FAIL_ASSERT("Can't get here.");
-  return 0;  // GCC knows kj.debug.FAIL_ASSERT doesn't return, but Eclipse CDT still warns...
+  cursor.inPos = srcPos;
+  return dstPos;
 };
 
-capnp.packed.PackedInputStream.prototype.skip = function(bytes) {
+/**
+ * @param {number} tag
+ * @return {number} Size in bytes of a packed group, not counting a 0xff group's tail.
+ */
+var groupSize = function(tag) {
+  return 1 + TAG_POPCOUNT[tag] + (tag === 0 || tag === 0xff ? 1 : 0);
+};
 
-  if (bytes === 0) {
-    return;
+/**
+ * Packs raw words or, given a message builder or array of segments, a whole message in stream
+ * format, without going through an output stream.  The result is identical to what
+ * writePackedMessage() produces.
+ *
+ * @param {ArrayBuffer|Array.<DataView>|capnp.message.MessageBuilder} arg
+ * @return {ArrayBuffer}
+ */
+capnp.packed.packToArrayBuffer = function(arg) {
+
+  var inputs = [];
+
+  if (kj.util.isArrayBuffer(arg)) {
+    inputs.push(new Uint8Array(arg));
   }
+  else {
+    var segments = kj.util.isArray(arg) ? arg : arg.getSegmentsForOutput();
 
-  kj.debug.DREQUIRE(bytes % capnp.common.BYTES_PER_WORD === 0, 'PackedInputStream reads must be word-aligned: ' + bytes);
+    var table = new DataView(new ArrayBuffer(((segments.length + 2) & ~1) * 4));
+    table.setUint32(0, segments.length - 1, true);
+    for (var i = 0, len = segments.length; i < len; ++i) {
+      table.setUint32((i + 1) << 2, segments[i].byteLength >>> 3, true);
+    }
+    inputs.push(new Uint8Array(table.buffer));
 
-  var buffer = this.inner.getReadBuffer();
-  var inPos = 0;
-  var inArray = new Uint8Array(buffer);
+    for (var i = 0, len = segments.length; i < len; ++i) {
+      inputs.push(new Uint8Array(segments[i].buffer, segments[i].byteOffset, segments[i].byteLength));
+    }
+  }
 
-  var self = this;
-  var REFRESH_BUFFER = function() {
-    self.inner.skip(self.buffer.byteLength);
-    self.buffer = self.inner.getReadBuffer();
-    inArray = new Uint8Array(buffer);
-    kj.debug.REQUIRE(self.buffer.byteLength > 0, 'Premature end of packed input.');
-    inPos = 0;
-  };
+  var maxSize = 0;
+  for (var i = 0, len = inputs.length; i < len; ++i) {
+    maxSize += capnp.packed.maxPackedSize(inputs[i].byteLength);
+  }
 
-  var BUFFER_END = function() { return buffer.byteLength; };
-  var BUFFER_REMAINING = function() { return BUFFER_END() - inPos; };
+  var out = new Uint8Array(maxSize);
+  var outPos = 0;
+  for (var i = 0, len = inputs.length; i < len; ++i) {
+    outPos = capnp.packed.packWords(inputs[i], 0, inputs[i].byteLength, out, outPos);
+  }
 
-  for (;;) {
-    var tag;
+  return out.buffer.slice(0, outPos);
+};
 
-    if (BUFFER_REMAINING() < 10) {
-      if (BUFFER_REMAINING() === 0) {
-        REFRESH_BUFFER();
-        continue;
-      }
+/**
+ * Unpacks a complete packed buffer.  If it holds a message, read it with
+ * FlatArrayMessageReader.
+ *
+ * @param {ArrayBuffer|Uint8Array} packed
+ * @return {ArrayBuffer}
+ */
+capnp.packed.unpackFromArrayBuffer = function(packed) {
+
+  var src = kj.util.isArrayBuffer(packed) ? new Uint8Array(packed) : packed;
+  var srcEnd = src.byteLength;
+
+  // Determine the unpacked size from the tags alone, so that the output can be allocated once.
+  var size = 0;
+  var pos = 0;
+  while (pos < srcEnd) {
+    var tag = src[pos];
+    pos += 1 + TAG_POPCOUNT[tag];
+    size += 8;
+    if (tag === 0) {
+      size += src[pos++] << 3;
+    } else if (tag === 0xff) {
+      var runLength = src[pos++] << 3;
+      size += runLength;
+      pos += runLength;
+    }
+  }
 
-      // We have at least 1, but not 10, bytes available.  We need to read slowly, doing a bounds
-      // check on each byte.
+  kj.debug.REQUIRE(pos === srcEnd, 'Premature end of packed input.');
 
-      tag = inArray[inPos++];
+  var out = new Uint8Array(size);
+  var cursor = { inPos: 0, pendingRun: 0, dstZeroed: true };
+  var outPos = unpackGroups(cursor, src, srcEnd, out, 0, size);
 
-      for (var i = 0; i < 8; i++) {
-        if (tag & (1 << i)) {
-          if (BUFFER_REMAINING() === 0) {
-            REFRESH_BUFFER();
-          }
-          inPos++;
-        }
-      }
-      bytes -= 8;
+  kj.debug.DASSERT(outPos === size && cursor.pendingRun === 0, 'Unpacked size mismatch.');
 
-      if (BUFFER_REMAINING() === 0 && (tag === 0 || tag === 0xff)) {
-        REFRESH_BUFFER();
-      }
-    } else {
-      tag = inArray[inPos++];
+  return out.buffer;
+};
 
-      for (var n = 0; n < 8; ++n) {
-        inPos += (tag & (1 << n)) != 0;
-      }
-      bytes -= 8;
-    }
+/**
+ * @constructor
+ */
+capnp.packed.PackedOutputStream = function(inner) {
+  kj.io.OutputStream.call(this);
+  this.inner = inner;
+  this.scratch = null;
+};
+capnp.packed.PackedOutputStream.prototype = Object.create(kj.io.OutputStream.prototype);
+capnp.packed.PackedOutputStream.prototype.constructor = capnp.packed.PackedOutputStream;
+capnp.packed.PackedOutputStream.prototype.write = function(src, offset, size) {
 
+  goog.asserts.assert(kj.util.isArrayBuffer(src), 'PackedOutputStream.write requires ArrayBuffer as first argument');
+  goog.asserts.assert(kj.util.isRegularNumber(offset), 'PackedOutputStream.write requires numeric offset as second argument');
+  goog.asserts.assert(kj.util.isRegularNumber(size), 'PackedOutputStream.write requires numeric size as third argument');
+  goog.asserts.assert(offset + size <= src.byteLength, 'PackedOutputStream.write asked to access buffer beyond end; byteLength=' + src.byteLength + ', offset=' + offset + ', size=' + size);
 
-    if (tag === 0) {
-      kj.debug.DASSERT(BUFFER_REMAINING() > 0, 'Should always have non-empty buffer here.');
+  var inArray = new Uint8Array(src, offset, size);
+  var maxSize = capnp.packed.maxPackedSize(size);
+  var buffer = this.inner.getWriteBuffer();
 
-      var runLength = inArray[inPos++] * capnp.common.BYTES_PER_WORD;
+  if (buffer.byteLength < maxSize) {
+    // Not enough room to pack straight into the output stream's buffer, so pack into our own
+    // and hand that over in one chunk.
+    if (this.scratch === null || this.scratch.byteLength < maxSize) {
+      this.scratch = new Uint8Array(maxSize);
+    }
+    buffer = this.scratch;
+  }
 
-      kj.debug.REQUIRE(runLength <= bytes, 'Packed input did not end cleanly on a segment boundary.');
+  var outPos = capnp.packed.packWords(inArray, 0, size, buffer, 0);
+  this.inner.write(buffer.buffer, buffer.byteOffset, outPos);
+};
 
-      bytes -= runLength;
+/**
+ * @constructor
+ */
+capnp.packed.PackedInputStream = function(inner) {
+  kj.io.InputStream.call(this);
+  this.inner = inner;
 
+  // Decoder state, see unpackGroups().
+  this.inPos = 0;
+  this.pendingRun = 0;
+  this.dstZeroed = false;
 
-    } else if (tag === 0xff) {
-      kj.debug.DASSERT(BUFFER_REMAINING() > 0, 'Should always have non-empty buffer here.');
+  // Holds a group which straddles two read buffers.
+  this.carry = new Uint8Array(10);
+};
+capnp.packed.PackedInputStream.prototype = Object.create(kj.io.InputStream.prototype);
+capnp.packed.PackedInputStream.prototype.constructor = capnp.packed.PackedInputStream;
 
-      var runLength = inArray[inPos++] * capnp.common.BYTES_PER_WORD;
+capnp.packed.PackedInputStream.prototype._getReadArray = function() {
+  var buffer = this.inner.getReadBuffer();
+  return kj.util.isArrayBuffer(buffer) ? new Uint8Array(buffer) : buffer;
+};
 
-      kj.debug.REQUIRE(runLength <= bytes, 'Packed input did not end cleanly on a segment boundary.');
+capnp.packed.PackedInputStream.prototype._unpack = function(dst, outPos, outMin, outEnd) {
 
-      bytes -= runLength;
+  var buffer = this._getReadArray();
+  this.inPos = 0;
 
-      var inRemaining = BUFFER_REMAINING();
-      if (inRemaining > runLength) {
-        // Fast path.
-        inPos += runLength;
-      } else {
-        // Forward skip to the underlying stream.
-        runLength -= inRemaining;
-        this.inner.skip(buffer.byteLength + runLength);
+  for (;;) {
+    outPos = unpackGroups(this, buffer, buffer.byteLength, dst, outPos, outEnd);
 
-        if (bytes === 0) {
-          return;
-        } else {
-          buffer = this.inner.getReadBuffer();
-          inArray = new Uint8Array(buffer);
-          inPos = 0;
+    if (outPos === outEnd || (outPos >= outMin && this.pendingRun === 0)) {
+      this.inner.skip(this.inPos);
+      return outPos;
+    }
 
-          // Skip the bounds check below since we just did the same check above.
-          continue;
+    if (this.inPos < buffer.byteLength && this.pendingRun === 0) {
+      // A group straddles the end of the buffer, so assemble it in carry and decode it from there.
+      var carry = this.carry;
+      var carried = buffer.byteLength - this.inPos;
+      carry.set(buffer.subarray(this.inPos), 0);
+
+      var needed = groupSize(carry[0]);
+      var pos = buffer.byteLength;
+      while (carried < needed) {
+        if (pos === buffer.byteLength) {
+          this.inner.skip(buffer.byteLength);
+          buffer = this._getReadArray();
+          pos = 0;
         }
+        carry[carried++] = buffer[pos++];
       }
-    }
 
-    if (bytes === 0) {
-      this.inner.skip(inPos);
-      return;
+      this.inPos = 0;
+      outPos = unpackGroups(this, carry, needed, dst, outPos, outEnd);
+      this.inPos = pos;
+      continue;
     }
+
+    this.inner.skip(buffer.byteLength);
+    buffer = this._getReadArray();
+    this.inPos = 0;
   }
+};
+
+capnp.packed.PackedInputStream.prototype.tryRead = function(dst, offset, minBytes, maxBytes) {
+
+  if (maxBytes === 0) {
+    return 0;
+  }
+
+  kj.debug.DREQUIRE(minBytes % capnp.common.BYTES_PER_WORD === 0, 'PackedInputStream reads must be word-aligned: ' + minBytes);
+  kj.debug.DREQUIRE(maxBytes % capnp.common.BYTES_PER_WORD === 0, 'PackedInputStream reads must be word-aligned: ' + maxBytes);
+
+  if (this.inner.tryGetReadBuffer().byteLength === 0) {
+    return 0;
+  }
+
+  var outArray = kj.util.isArrayBuffer(dst) ? new Uint8Array(dst) : dst;
+  return this._unpack(outArray, offset, offset + minBytes, offset + maxBytes) - offset;
+};
+
+capnp.packed.PackedInputStream.prototype.skip = function(bytes) {
+
+  if (bytes === 0) {
+    return;
+  }
+
+  kj.debug.DREQUIRE(bytes % capnp.common.BYTES_PER_WORD === 0, 'PackedInputStream reads must be word-aligned: ' + bytes);
 
-  kj.debug.FAIL_ASSERT("Can't get here.");
+  this._unpack(null, 0, bytes, bytes);
 };
 
 capnp.packed.writePackedMessage = function(output, arg) {
@@ -0,0 +1,27 @@
+#!/bin/sh
+
+#-------------------- edit here >>>
+closure_library=../capnproto-js/thirdparty/closure-library
+compiler_jar=../capnproto-js/thirdparty/compiler.jar
+#-------------------- <<< edit here
+
+set -exuo pipefail
+
+srcdir=${srcdir:-$(dirname $0)/../c++}
+
+mkdir -p dist
+
+python $closure_library/closure/bin/build/closurebuilder.py \
+    --root=${srcdir}/../javascript/lib/ \
+    --root=${srcdir}/../javascript/benchmarks/ \
+    --root=$closure_library/ \
+    --root=src/capnp/benchmark \
+    --namespace='capnp.benchmarks' \
+    --output_mode=compiled \
+    --compiler_jar=$compiler_jar \
+    --compiler_flags="--compilation_level=SIMPLE_OPTIMIZATIONS" \
+    --compiler_flags="--language_in=ECMASCRIPT_2020" \
+    --compiler_flags="--language_out=ECMASCRIPT_2020" \
+    > dist/capnp_benchmarks.js
+
+node --expose-gc ${srcdir}/../javascript/benchmarks/run.js dist/capnp_benchmarks.js "$@"
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2013, Julian Scheid <julians37@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+goog.provide('capnp.tests.bigint');
+
+goog.require('capnp.message');
+
+goog.require('capnproto_test.capnp.test');
+
+// These tests run against the test schemas generated with capnpc-js --bigint, see build-tests.sh.
+
+var test = capnproto_test.capnp.test;
+
+window['test_BigIntFields'] = function() {
+
+  var builder = new capnp.message.MallocMessageBuilder();
+  var root = builder.initRoot(test.TestAllTypes);
+  root.setInt64Field(BigInt('-123456789012345'));
+  root.setUInt64Field(BigInt('12345678901234567890'));
+
+  assertEquals(BigInt('-123456789012345'), root.getInt64Field());
+  assertEquals(BigInt('12345678901234567890'), root.getUInt64Field());
+
+  var reader = new capnp.message.SegmentArrayMessageReader(builder.getSegmentsForOutput()).getRoot(test.TestAllTypes);
+  assertEquals(BigInt('-123456789012345'), reader.getInt64Field());
+  assertEquals(BigInt('12345678901234567890'), reader.getUInt64Field());
+
+  // Plain numbers are accepted as well.
+  root.setInt64Field(-5);
+  root.setUInt64Field(7);
+  assertEquals(BigInt(-5), root.getInt64Field());
+  assertEquals(BigInt(7), root.getUInt64Field());
+
+  assertEquals(BigInt(0), new test.TestAllTypes.Reader().getInt64Field());
+};
+
+window['test_BigIntDefaults'] = function() {
+
+  var reader = new test.TestDefaults.Reader();
+  assertEquals(BigInt('-123456789012345'), reader.getInt64Field());
+  assertEquals(BigInt('12345678901234567890'), reader.getUInt64Field());
+
+  var builder = new capnp.message.MallocMessageBuilder();
+  var root = builder.initRoot(test.TestDefaults);
+  assertEquals(BigInt('-123456789012345'), root.getInt64Field());
+  assertEquals(BigInt('12345678901234567890'), root.getUInt64Field());
+
+  // Values are stored XORed with the default.
+  root.setInt64Field(BigInt(0));
+  root.setUInt64Field(1);
+  assertEquals(BigInt(0), root.getInt64Field());
+  assertEquals(BigInt(1), root.getUInt64Field());
+};
+
+window['test_BigIntLists'] = function() {
+
+  var builder = new capnp.message.MallocMessageBuilder();
+  var root = builder.initRoot(test.TestAllTypes);
+  root.setInt64List([BigInt('1111111111111111111'), -1]);
+  root.setUInt64List(new BigUint64Array([BigInt('11111111111111111111')]));
+
+  var int64List = root.asReader().getInt64List();
+  assertEquals(2, int64List.size());
+  assertEquals(BigInt('1111111111111111111'), int64List.get(0));
+  assertEquals(BigInt(-1), int64List.get(1));
+  assertTrue(int64List.asTypedArray() instanceof BigInt64Array);
+  assertEquals(BigInt('11111111111111111111'), root.getUInt64List().get(0));
+
+  var defaults = new test.TestDefaults.Reader().getInt64List();
+  assertEquals(BigInt('1111111111111111111'), defaults.get(0));
+  assertEquals(BigInt('-1111111111111111111'), defaults.get(1));
+};
+
+window['test_BigIntConstants'] = function() {
+
+  assertEquals(BigInt('-123456789012345'), test.TestConstants.INT64_CONST);
+  assertEquals(BigInt('12345678901234567890'), test.TestConstants.UINT64_CONST);
+  assertEquals(BigInt('56789012345678'), test.TestConstants.STRUCT_CONST.get().getInt64Field());
+  assertEquals(BigInt('345678901234567890'), test.TestConstants.STRUCT_CONST.get().getUInt64Field());
+};
+
+window['test_BigIntToObjectFromObject'] = function() {
+
+  var builder = new capnp.message.MallocMessageBuilder();
+  var root = builder.initRoot(test.TestDefaults);
+  root.setInt64Field(BigInt(42));
+
+  var obj = root.asReader().toObject();
+  assertEquals(BigInt(42), obj.int64Field);
+  assertEquals(BigInt('12345678901234567890'), obj.uInt64Field);
+
+  // fromObject() takes plain JSON numbers too, through the masked and unmasked paths alike.
+  var builder2 = new capnp.message.MallocMessageBuilder();
+  var root2 = builder2.initRoot(test.TestDefaults);
+  root2.fromObject({ int64Field: -5, uInt64Field: 7 });
+  assertEquals(BigInt(-5), root2.getInt64Field());
+  assertEquals(BigInt(7), root2.getUInt64Field());
+
+  var builder3 = new capnp.message.MallocMessageBuilder();
+  var root3 = builder3.initRoot(test.TestAllTypes);
+  root3.fromObject({ int64Field: -5, uInt64Field: 7 });
+  assertEquals(BigInt(-5), root3.getInt64Field());
+  assertEquals(BigInt(7), root3.getUInt64Field());
+};
@@ -1606,3 +1606,81 @@ window['test_StructSetters'] = function() {
     capnp.test.util.checkTestMessage(root2.getObjectField(test.TestAllTypes));
   }
 };
+
+window['test_ToObjectFromObject'] = function() {
+
+  var builder = new capnp.message.MallocMessageBuilder();
+  capnp.test.util.initTestMessage(builder.initRoot(test.TestAllTypes));
+
+  var reader = new capnp.message.SegmentArrayMessageReader(builder.getSegmentsForOutput());
+  var obj = reader.getRoot(test.TestAllTypes).toObject();
+
+  assertEquals(-12345678, obj.int32Field);
+  assertEquals("foo", obj.textField);
+  assertEquals("really nested", obj.structField.structField.structField.textField);
+  assertEquals(test.TestEnum.BAZ, obj.structField.enumField);
+  assertArrayEquals([12345678, -90123456, -0x7fffffff - 1, 0x7fffffff], obj.structField.int32List);
+
+  var builder2 = new capnp.message.MallocMessageBuilder();
+  builder2.initRoot(test.TestAllTypes).fromObject(obj);
+  capnp.test.util.checkTestMessage(builder2.getRoot(test.TestAllTypes));
+  capnp.test.util.checkTestMessage(builder2.getRoot(test.TestAllTypes).asReader());
+
+  // A null struct list element is left zeroed.
+  obj.structList[1] = null;
+  var builder3 = new capnp.message.MallocMessageBuilder();
+  builder3.initRoot(test.TestAllTypes).fromObject(obj);
+  var structList = builder3.getRoot(test.TestAllTypes).asReader().getStructList();
+  assertEquals(3, structList.size());
+  assertEquals("structlist 1", structList.get(0).getTextField().toString());
+  assertFalse(structList.get(1).hasTextField());
+  assertEquals(0, structList.get(1).getInt32Field());
+  assertEquals("structlist 3", structList.get(2).getTextField().toString());
+};
+
+window['test_ToObjectEmpty'] = function() {
+
+  var obj = new test.TestAllTypes.Reader().toObject();
+  assertEquals(0, obj.int32Field);
+  assertNull(obj.textField);
+  assertNull(obj.structField);
+  assertNull(obj.int32List);
+
+  var builder = new capnp.message.MallocMessageBuilder();
+  builder.initRoot(test.TestAllTypes).fromObject(obj);
+  capnp.test.util.checkTestMessageAllZero(builder.getRoot(test.TestAllTypes).asReader());
+};
+
+window['test_ToObjectUnions'] = function() {
+
+  {
+    var builder = new capnp.message.MallocMessageBuilder();
+    builder.initRoot(test.TestUnnamedUnion).setBar(321);
+    var obj = builder.getRoot(test.TestUnnamedUnion).toObject();
+    assertEquals(321, obj.bar);
+    assertFalse('foo' in obj);
+
+    var builder2 = new capnp.message.MallocMessageBuilder();
+    builder2.initRoot(test.TestUnnamedUnion).fromObject(obj);
+    assertEquals(test.TestUnnamedUnion.BAR, builder2.getRoot(test.TestUnnamedUnion).which());
+    assertEquals(321, builder2.getRoot(test.TestUnnamedUnion).getBar());
+  }
+
+  {
+    var builder = new capnp.message.MallocMessageBuilder();
+    var bar = builder.initRoot(test.TestGroups).getGroups().initBar();
+    bar.setCorge(23456789);
+    bar.setGrault("barbaz");
+    var obj = builder.getRoot(test.TestGroups).asReader().toObject();
+    assertEquals(23456789, obj.groups.bar.corge);
+    assertEquals("barbaz", obj.groups.bar.grault);
+    assertFalse('foo' in obj.groups);
+
+    var builder2 = new capnp.message.MallocMessageBuilder();
+    builder2.initRoot(test.TestGroups).fromObject(obj);
+    var root2 = builder2.getRoot(test.TestGroups).asReader();
+    assertEquals(test.TestGroups.Groups.BAR, root2.getGroups().which());
+    assertEquals(23456789, root2.getGroups().getBar().getCorge());
+    assertEquals("barbaz", root2.getGroups().getBar().getGrault().toString());
+  }
+};
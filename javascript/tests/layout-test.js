@@ -263,13 +263,164 @@ window['test_SimpleRawDataStruct'] = function() {
 
 }
 
+window['test_SimpleRawDataStruct_BigInt'] = function() {
+
+  var data = new Uint8Array([
+    // Struct ref, offset = 1, dataSize = 1, pointerCount = 0
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    // Content for the data section.
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef
+  ]).buffer
+
+  var reader = capnp.layout.StructReader.readRootUnchecked(new DataView(data));
+
+  assertEquals(BigInt('0xefcdab8967452301'), reader.getDataField_biguint64(0));
+  assertEquals(-BigInt('0x1032547698badcff'), reader.getDataField_bigint64(0));
+  assertEquals(BigInt(0), reader.getDataField_biguint64(1));
+  assertEquals(BigInt('0xefcdab8967452301') ^ BigInt(321), reader.getDataField_biguint64_masked(0, BigInt(321)));
+  assertEquals(BigInt(-321), reader.getDataField_bigint64_masked(1, BigInt(-321)));
+
+  assertEquals(reader.getDataField_biguint64(0), capnp.prim.uint64ToBigInt(reader.getDataField_uint64(0)));
+  assertEquals(reader.getDataField_bigint64(0), capnp.prim.int64ToBigInt(reader.getDataField_int64(0)));
+  assertArrayEquals(reader.getDataField_int64(0), capnp.prim.bigIntToInt64(reader.getDataField_bigint64(0)));
+  assertArrayEquals(reader.getDataField_uint64(0), capnp.prim.bigIntToUint64(reader.getDataField_biguint64(0)));
+};
+
+window['test_BigIntSettersCoerceNumbers'] = function() {
+
+  var message = new capnp.message.MallocMessageBuilder();
+  var builder = capnp.layout.StructBuilder.initRoot(
+    message.getRootSegment(), 0, new capnp.layout.StructSize(2, 0, capnp.layout.FieldSize.INLINE_COMPOSITE));
+
+  builder.setDataField_bigint64(0, -5);
+  builder.setDataField_biguint64_masked(1, 7, BigInt(3));
+  assertEquals(BigInt(-5), builder.getDataField_bigint64(0));
+  assertEquals(BigInt(7), builder.getDataField_biguint64_masked(1, BigInt(3)));
+  assertEquals(BigInt(4), builder.getDataField_biguint64(1));
+};
+
+window['test_BigIntListAsTypedArray'] = function() {
+
+  var message = new capnp.message.MallocMessageBuilder();
+  var root = capnp.layout.StructBuilder.initRoot(
+    message.getRootSegment(), 0, new capnp.layout.StructSize(0, 2, capnp.layout.FieldSize.INLINE_COMPOSITE));
+  var listType = capnp.list.ListOfPrimitives(capnp.prim.bigint64_t);
+  var list = listType.initBuilder(root, 0, 3);
+  list.set(0, BigInt(-1));
+  list.set(1, BigInt(1) << BigInt(62));
+  list.set(2, 12345);
+
+  var array = list.asTypedArray();
+  assertTrue(array instanceof BigInt64Array);
+  assertEquals(3, array.length);
+  assertEquals(BigInt(-1), array[0]);
+  assertEquals(BigInt(1) << BigInt(62), array[1]);
+  assertEquals(BigInt(12345), array[2]);
+
+  // The array aliases the segment.
+  array[2] = BigInt(7);
+  assertEquals(BigInt(7), listType.getReader(root.asReader(), 0).get(2));
+  assertEquals(BigInt(7), listType.getReader(root.asReader(), 0).asTypedArray()[2]);
+  assertEquals(0, listType.getReader(root.asReader(), 1).asTypedArray().length);
+};
+
+window['test_PrimitiveListAsTypedArray'] = function() {
+
+  var message = new capnp.message.MallocMessageBuilder();
+  var root = capnp.layout.StructBuilder.initRoot(
+    message.getRootSegment(), 0, new capnp.layout.StructSize(0, 4, capnp.layout.FieldSize.INLINE_COMPOSITE));
+
+  var classes = [capnp.prim.int8_t, capnp.prim.uint16_t, capnp.prim.int32_t, capnp.prim.float64_t];
+  var values = [-5, 1, 2, 127];
+  for (var i = 0; i < classes.length; ++i) {
+    var listType = capnp.list.ListOfPrimitives(classes[i]);
+    var list = listType.initBuilder(root, i, values.length);
+    for (var j = 0; j < values.length; ++j) {
+      list.set(j, values[j]);
+    }
+
+    var array = listType.getReader(root.asReader(), i).asTypedArray();
+    assertTrue(array instanceof classes[i].TypedArray);
+    assertArrayEquals(Array.from(new classes[i].TypedArray(values)), Array.from(array));
+
+    // The array aliases the segment.
+    array[3] = 42;
+    assertEquals(42, list.get(3));
+    assertEquals(42, list.asTypedArray()[3]);
+  }
+
+  // A segment at an odd offset within its buffer can't be aliased, but still reads correctly.
+  var bytes = message.getSegmentsForOutput()[0];
+  var buffer = new ArrayBuffer(bytes.byteLength + 1);
+  new Uint8Array(buffer, 1).set(new Uint8Array(bytes.buffer, bytes.byteOffset, bytes.byteLength));
+  var segment = new capnp.arena.SegmentReader(null, 0, new DataView(buffer, 1, bytes.byteLength), new capnp.arena.ReadLimiter());
+  var reader = capnp.layout.StructReader.readRoot(0, segment, 64);
+  var array = capnp.list.ListOfPrimitives(capnp.prim.float64_t).getReader(reader, 3).asTypedArray();
+  assertArrayEquals([-5, 1, 2, 42], Array.from(array));
+  array[0] = 0;
+  assertEquals(-5, capnp.list.ListOfPrimitives(capnp.prim.float64_t).getReader(reader, 3).get(0));
+};
+
+window['test_PrimitiveListSetAll'] = function() {
+
+  var message = new capnp.message.MallocMessageBuilder();
+  var root = capnp.layout.StructBuilder.initRoot(
+    message.getRootSegment(), 0, new capnp.layout.StructSize(0, 4, capnp.layout.FieldSize.INLINE_COMPOSITE));
+
+  var listType = capnp.list.ListOfPrimitives(capnp.prim.uint32_t);
+  var list = listType.initBuilder(root, 0, 3);
+  list.setAll(new Uint32Array([1, 0xffffffff, 3]));
+  assertArrayEquals([1, 0xffffffff, 3], Array.from(listType.getReader(root.asReader(), 0).asTypedArray()));
+  list.setAll([4, -1, 6]);
+  assertEquals(0xffffffff, list.get(1));
+  assertEquals(6, list.get(2));
+  assertThrows(function() { list.setAll([1, 2]); });
+
+  var floats = capnp.list.ListOfPrimitives(capnp.prim.float32_t).initFrom(root, 1, new Float32Array([0.5, -2.25]));
+  assertEquals(2, floats.size());
+  assertEquals(-2.25, floats.get(1));
+
+  var bigints = capnp.list.ListOfPrimitives(capnp.prim.bigint64_t).initFrom(root, 2, [1, -2]);
+  assertEquals(BigInt(-2), bigints.get(1));
+
+  capnp.genhelper.listSet(capnp.list.ListOfPrimitives(capnp.prim.int16_t), root, 3, new Int16Array([7, -8]));
+  assertEquals(-8, capnp.list.ListOfPrimitives(capnp.prim.int16_t).getReader(root.asReader(), 3).get(1));
+};
+
+window['test_TextBlobUtf8'] = function() {
+
+  var message = new capnp.message.MallocMessageBuilder();
+  var root = capnp.layout.StructBuilder.initRoot(
+    message.getRootSegment(), 0, new capnp.layout.StructSize(0, 3, capnp.layout.FieldSize.INLINE_COMPOSITE));
+
+  var str = 'héllo wörld ✓ 😀';
+  assertEquals(new TextEncoder().encode(str).length, capnp.blob.utf8Length(str));
+  assertEquals(3, capnp.blob.utf8Length('\ud800'));
+
+  root.setTextBlobField(0, str);
+  root.setTextBlobField(1, new capnp.blob.StringTextReader(str));
+  root.setTextBlobField(2, root.asReader().getTextBlobField(0, null, 0));
+
+  for (var i = 0; i < 3; ++i) {
+    var builder = root.getTextBlobField(i, null, 0);
+    assertEquals(capnp.blob.utf8Length(str), builder.size());
+    assertEquals(str, builder.str());
+    assertEquals(0, root.segment.getUint8Array()[builder.begin() + builder.size()]);
+  }
+
+  var reader = root.asReader().getTextBlobField(0, null, 0);
+  assertTrue(reader instanceof capnp.blob.Text.Reader);
+  assertEquals(str, reader.str());
+  assertTrue(reader.str() === reader.toString());
+  assertEquals('', root.asReader().getTextBlobField(3, null, 0).str());
+};
+
 window['test_StructRoundTrip_OneSegment'] = function() {
 
   var message = new capnp.message.MallocMessageBuilder();
   var arena = new capnp.arena.BuilderArena(message);
-  var allocation = arena.allocate(1);
-  var segment = allocation.segment;
-  var rootLocation = allocation.words;
+  var segment = arena.allocate(1);
+  var rootLocation = arena.allocatedWords;
 
   var builder = capnp.layout.StructBuilder.initRoot(
     segment, rootLocation, new capnp.layout.StructSize(2, 4, capnp.layout.FieldSize.INLINE_COMPOSITE));
@@ -306,9 +457,8 @@ window['test_StructRoundTrip_OneSegmentPerAllocation'] = function() {
 
   var message = new capnp.message.MallocMessageBuilder(0, capnp.message.AllocationStrategy.FIXED_SIZE);
   var arena = new capnp.arena.BuilderArena(message);
-  var allocation = arena.allocate(1);
-  var segment = allocation.segment;
-  var rootLocation = allocation.words;
+  var segment = arena.allocate(1);
+  var rootLocation = arena.allocatedWords;
 
   var builder = capnp.layout.StructBuilder.initRoot(
     segment, rootLocation, new capnp.layout.StructSize(2, 4, capnp.layout.FieldSize.INLINE_COMPOSITE));
@@ -345,9 +495,8 @@ window['test_StructRoundTrip_MultipleSegmentsWithMultipleAllocations'] = functio
 
   var message = new capnp.message.MallocMessageBuilder(8, capnp.message.AllocationStrategy.FIXED_SIZE);
   var arena = new capnp.arena.BuilderArena(message);
-  var allocation = arena.allocate(1);
-  var segment = allocation.segment;
-  var rootLocation = allocation.words;
+  var segment = arena.allocate(1);
+  var rootLocation = arena.allocatedWords;
 
   var builder = capnp.layout.StructBuilder.initRoot(
     segment, rootLocation, new capnp.layout.StructSize(2, 4, capnp.layout.FieldSize.INLINE_COMPOSITE));
@@ -370,3 +519,129 @@ window['test_StructRoundTrip_MultipleSegmentsWithMultipleAllocations'] = functio
   checkStructWithReader(builder.asReader());
   checkStructWithReader(capnp.layout.StructReader.readRoot(0, segment, 4));
 }
+
+var buildSetupStruct = function(message) {
+  var builder = capnp.layout.StructBuilder.initRoot(
+    message.getRootSegment(), 0, new capnp.layout.StructSize(2, 4, capnp.layout.FieldSize.INLINE_COMPOSITE));
+  setupStruct(builder);
+  return new Uint8Array(capnp.serialize.messageToFlatArray(message.getSegmentsForOutput()));
+};
+
+window['test_MessageBuilderReset'] = function() {
+
+  var message = new capnp.message.MallocMessageBuilder(8, capnp.message.AllocationStrategy.FIXED_SIZE);
+  var expected = buildSetupStruct(message);
+  var buffers = message.getSegmentsForOutput().map(function(segment) { return segment.buffer; });
+  assertEquals(6, buffers.length);
+
+  message.reset();
+  assertEquals(1, message.getSegmentsForOutput().length);
+  assertEquals(8, message.getSegmentsForOutput()[0].byteLength);
+  message.getRootSegment().validateIntegrity();
+
+  assertArrayEquals(expected, buildSetupStruct(message));
+
+  // The same segments were used again, in the same order.
+  var segments = message.getSegmentsForOutput();
+  for (var i = 0; i < segments.length; i++) {
+    assertTrue(segments[i].buffer === buffers[i]);
+  }
+
+  // Reusing segments doesn't count as growth: after any number of rounds, a message that needs
+  // more space gets the same new segments as if the builder had never been reset.
+  var reference = new capnp.message.MallocMessageBuilder(8);
+  buildSetupStruct(reference);
+  buildSetupStruct(reference);
+
+  var growing = new capnp.message.MallocMessageBuilder(8);
+  buildSetupStruct(growing);
+  var buffers = growing.getSegmentsForOutput().map(function(segment) { return segment.buffer; });
+  for (var i = 0; i < 100; i++) {
+    growing.reset();
+    buildSetupStruct(growing);
+    checkStructWithReader(capnp.layout.StructReader.readRoot(0, growing.getRootSegment(), 4));
+    assertArrayEquals(buffers, growing.getSegmentsForOutput().map(function(segment) { return segment.buffer; }));
+  }
+  buildSetupStruct(growing);
+
+  var bufferSizes = function(message) {
+    return message.getSegmentsForOutput().map(function(segment) { return segment.buffer.byteLength; });
+  };
+  assertArrayEquals(bufferSizes(reference), bufferSizes(growing));
+};
+
+window['test_MessageBuilderFirstSegment'] = function() {
+
+  var scratch = new ArrayBuffer(1024 * 8);
+  new Uint8Array(scratch).fill(0xff);
+
+  var message = new capnp.message.MallocMessageBuilder(scratch);
+  var expected = buildSetupStruct(new capnp.message.MallocMessageBuilder());
+  assertArrayEquals(expected, buildSetupStruct(message));
+  assertTrue(message.getSegmentsForOutput()[0].buffer === scratch);
+
+  message.dispose();
+  assertArrayEquals(expected, buildSetupStruct(message));
+  assertTrue(message.getSegmentsForOutput()[0].buffer === scratch);
+};
+
+window['test_MessageBuilderDisposeSegmentSizes'] = function() {
+
+  var bufferSizes = function(message) {
+    return message.getSegmentsForOutput().map(function(segment) { return segment.buffer.byteLength; });
+  };
+
+  // Once disposed, a builder grows its segments from the initial size again, like a fresh one.
+  var growing = new capnp.message.MallocMessageBuilder(8);
+  buildSetupStruct(growing);
+  var expected = bufferSizes(growing);
+  growing.dispose();
+  buildSetupStruct(growing);
+  checkStructWithReader(capnp.layout.StructReader.readRoot(0, growing.getRootSegment(), 4));
+  assertArrayEquals(expected, bufferSizes(growing));
+};
+
+window['test_MessageBuilderSegmentPool'] = function() {
+
+  var pool = new capnp.message.SegmentPool();
+
+  var message = new capnp.message.MallocMessageBuilder(8, capnp.message.AllocationStrategy.FIXED_SIZE, pool);
+  buildSetupStruct(message);
+  var buffers = message.getSegmentsForOutput().map(function(segment) { return segment.buffer; });
+  message.dispose();
+
+  // A second builder borrows the same, zeroed, buffers.
+  var message2 = new capnp.message.MallocMessageBuilder(8, capnp.message.AllocationStrategy.FIXED_SIZE, pool);
+  buildSetupStruct(message2);
+  checkStructWithReader(capnp.layout.StructReader.readRoot(0, message2.getRootSegment(), 4));
+  message2.getSegmentsForOutput().forEach(function(segment) {
+    assertTrue(buffers.indexOf(segment.buffer) >= 0);
+  });
+
+  // All of them are back in the pool afterwards, and zeroed.
+  message2.dispose();
+  var acquired = [];
+  for (var buffer; (buffer = pool.acquire(1)) !== null; ) {
+    assertTrue(buffers.indexOf(buffer) >= 0);
+    assertTrue(acquired.indexOf(buffer) < 0);
+    assertTrue(new Uint8Array(buffer).every(function(b) { return b === 0; }));
+    acquired.push(buffer);
+  }
+  assertEquals(buffers.length, acquired.length);
+
+  // acquire() hands back a released buffer if it is large enough.
+  pool.release(acquired[0]);
+  assertNull(pool.acquire(acquired[0].byteLength / 8 + 1));
+  assertTrue(pool.acquire(1) === acquired[0]);
+
+  // The pool doesn't grow beyond its limit.
+  var smallPool = new capnp.message.SegmentPool(16);
+  var message3 = new capnp.message.MallocMessageBuilder(8, capnp.message.AllocationStrategy.FIXED_SIZE, smallPool);
+  buildSetupStruct(message3);
+  message3.dispose();
+  var pooledWords = 0;
+  for (var buffer; (buffer = smallPool.acquire(1)) !== null; ) {
+    pooledWords += buffer.byteLength / 8;
+  }
+  assertEquals(16, pooledWords);
+};
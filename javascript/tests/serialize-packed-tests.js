@@ -275,9 +275,27 @@ var expectPacksToWithReadSize = function(unpacked, packed, preferredReadSize) {
   assertTrue(pipe.allRead());
 }
 
+var expectPacksToOneShot = function(unpacked, packed) {
+
+  var actual = new Uint8Array(capnp.packed.packToArrayBuffer(new Uint8Array(unpacked).buffer));
+  if (!equalBuffer(actual, packed)) {
+    fail("Tried to pack: " + DisplayByteArray(unpacked) + "\n" +
+         "Expected:      " + DisplayByteArray(packed) + "\n" +
+         "Actual:        " + DisplayByteArray(actual));
+  }
+
+  var roundTrip = new Uint8Array(capnp.packed.unpackFromArrayBuffer(new Uint8Array(packed).buffer));
+  if (!equalBuffer(roundTrip, unpacked)) {
+    fail("Tried to unpack: " + DisplayByteArray(packed) + "\n" +
+         "Expected:        " + DisplayByteArray(unpacked) + "\n" +
+         "Actual:          " + DisplayByteArray(roundTrip));
+  }
+};
+
 var expectPacksTo = function(unpacked, packed) {
   expectPacksToWithReadSize(unpacked, packed, undefined);
   expectPacksToWithReadSize(unpacked, packed, 1);
+  expectPacksToOneShot(unpacked, packed);
 };
 
 window['test_SimplePacking'] = function() {
@@ -314,6 +332,21 @@ window['test_RoundTrip'] = function() {
   capnp.test.util.checkTestMessage(reader.getRoot(test.TestAllTypes));
 };
 
+window['test_RoundTripOneShot'] = function() {
+
+  var builder = new capnp.test.util.TestMessageBuilder(7);
+  capnp.test.util.initTestMessage(builder.initRoot(test.TestAllTypes));
+
+  var pipe = new TestPipe();
+  capnp.packed.writePackedMessage(pipe.outputStream, builder);
+
+  var packed = capnp.packed.packToArrayBuffer(builder);
+  assertTrue(equalBuffer(new Uint8Array(packed), pipe.getData()));
+
+  var reader = new capnp.message.FlatArrayMessageReader(capnp.packed.unpackFromArrayBuffer(packed));
+  capnp.test.util.checkTestMessage(reader.getRoot(test.TestAllTypes));
+};
+
 window['test_RoundTripScratchSpace'] = function() {
 
   var builder = new capnp.test.util.TestMessageBuilder(1);
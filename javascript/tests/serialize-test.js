@@ -272,6 +272,287 @@ window['test_WriteMessageEvenSegmentCount'] = function() {
   assertTrue(output.dataEquals(serialized));
 };
 
+var framedMessages = function(serialized, chunkSize) {
+  var readers = [];
+  var framer = new capnp.serialize.StreamFramer(function(reader) { readers.push(reader); });
+  var bytes = new Uint8Array(serialized);
+  for (var i = 0; i < bytes.byteLength; i += chunkSize) {
+    framer.push(bytes.subarray(i, i + chunkSize));
+  }
+  framer.end();
+  return readers;
+};
+
+window['test_StreamFramer'] = function() {
+
+  var builder = new capnp.test.util.TestMessageBuilder(7);
+  capnp.test.util.initTestMessage(builder.initRoot(test.TestAllTypes));
+
+  var serialized = capnp.serialize.messageToFlatArray(builder.getSegmentsForOutput());
+
+  // Two messages back to back, split at every possible granularity.
+  var twice = new Uint8Array(serialized.byteLength * 2);
+  twice.set(new Uint8Array(serialized), 0);
+  twice.set(new Uint8Array(serialized), serialized.byteLength);
+
+  var chunkSizes = [1, 3, 8, 13, 100, twice.byteLength];
+  for (var i = 0; i < chunkSizes.length; ++i) {
+    var readers = framedMessages(twice.buffer, chunkSizes[i]);
+    assertEquals(2, readers.length);
+    capnp.test.util.checkTestMessage(readers[0].getRoot(test.TestAllTypes));
+    capnp.test.util.checkTestMessage(readers[1].getRoot(test.TestAllTypes));
+  }
+};
+
+window['test_StreamFramerZeroCopy'] = function() {
+
+  var builder = new capnp.test.util.TestMessageBuilder(1);
+  capnp.test.util.initTestMessage(builder.initRoot(test.TestAllTypes));
+
+  var serialized = capnp.serialize.messageToFlatArray(builder.getSegmentsForOutput());
+
+  var readers = framedMessages(serialized, serialized.byteLength);
+  assertEquals(1, readers.length);
+  assertTrue(readers[0].getSegment(0).buffer === serialized);
+  capnp.test.util.checkTestMessage(readers[0].getRoot(test.TestAllTypes));
+};
+
+window['test_StreamFramerRejectHuge'] = function() {
+
+  var data = new ArrayBuffer(32);
+  var table = new Uint32Array(data);
+  table[1] = 3;
+
+  var framer = new capnp.serialize.StreamFramer(function() {}, { traversalLimitInWords: 2 });
+
+  // Only the segment table has arrived, but that is enough to reject the message.
+  assertThrows(function() { framer.push(data.slice(0, 8)); });
+};
+
+window['test_StreamFramerPrematureEof'] = function() {
+
+  var builder = new capnp.test.util.TestMessageBuilder(1);
+  capnp.test.util.initTestMessage(builder.initRoot(test.TestAllTypes));
+
+  var serialized = capnp.serialize.messageToFlatArray(builder.getSegmentsForOutput());
+
+  var framer = new capnp.serialize.StreamFramer(function() { fail('unexpected message'); });
+  framer.push(serialized.slice(0, serialized.byteLength - 8));
+  assertThrows(function() { framer.end(); });
+};
+
+var int32Message = function(value) {
+  var builder = new capnp.message.MallocMessageBuilder();
+  capnp.layout.StructBuilder.initRoot(
+    builder.getRootSegment(), 0, new capnp.layout.StructSize(1, 0, capnp.layout.FieldSize.INLINE_COMPOSITE)).setDataField_int32(0, value);
+  return capnp.serialize.messageToFlatArray(builder.getSegmentsForOutput());
+};
+
+window['test_StreamFramerBackpressure'] = function() {
+
+  var framer = new capnp.serialize.StreamFramer(null, { highWaterMark: 2 });
+  var pauses = 0;
+  var resumes = 0;
+  framer.pauseSource = function() { ++pauses; };
+  framer.resumeSource = function() { ++resumes; };
+
+  framer.push(int32Message(0));
+  assertEquals(0, pauses);
+  framer.push(int32Message(1));
+  assertEquals(1, pauses);
+  framer.push(int32Message(2));
+  assertEquals(1, pauses);
+
+  framer.next();
+  assertEquals(0, resumes);
+  framer.next();
+  assertEquals(1, resumes);
+};
+
+window['test_StreamFramerQueueOrder'] = function() {
+
+  var framer = new capnp.serialize.StreamFramer();
+  var count = 3000;
+  for (var i = 0; i < count; ++i) {
+    framer.push(int32Message(i));
+  }
+  framer.end();
+
+  var results = [];
+  for (var i = 0; i <= count; ++i) {
+    results.push(framer.next());
+  }
+  return Promise.all(results).then(function(results) {
+    for (var i = 0; i < count; ++i) {
+      assertFalse(results[i].done);
+      assertEquals(i, results[i].value.getRootInternal().getDataField_int32(0));
+    }
+    assertTrue(results[count].done);
+  });
+};
+
+/**
+ *  Just enough of a Node.js Readable stream for readMessageStream().
+ *  @constructor
+ */
+var FakeStream = function() {
+  this.handlers = {};
+  this.destroyed = null;
+};
+FakeStream.prototype.on = function(event, handler) { this.handlers[event] = handler; };
+FakeStream.prototype.emit = function(event, arg) { this.handlers[event](arg); };
+FakeStream.prototype.pause = function() {};
+FakeStream.prototype.resume = function() {};
+FakeStream.prototype.destroy = function(e) { this.destroyed = e; this.emit('error', e); };
+
+window['test_ReadMessageStreamErrors'] = function() {
+
+  // A truncated last message in callback mode.
+  var stream = new FakeStream();
+  var messages = [];
+  var errors = [];
+  capnp.serialize.readMessageStream(stream, null,
+                                    function(reader) { messages.push(reader); },
+                                    function(e) { errors.push(e); });
+
+  var serialized = int32Message(42);
+  stream.emit('data', new Uint8Array(serialized));
+  stream.emit('data', new Uint8Array(serialized.slice(0, serialized.byteLength - 8)));
+  stream.emit('end');
+  assertEquals(1, messages.length);
+  assertEquals(42, messages[0].getRootInternal().getDataField_int32(0));
+  assertEquals(1, errors.length);
+
+  // Errors of the stream itself.
+  stream = new FakeStream();
+  errors = [];
+  capnp.serialize.readMessageStream(stream, null, function() {}, function(e) { errors.push(e); });
+  var error = new Error('read failed');
+  stream.emit('error', error);
+  assertEquals(1, errors.length);
+  assertTrue(errors[0] === error);
+
+  // Framing errors destroy the stream and are reported once.
+  stream = new FakeStream();
+  errors = [];
+  capnp.serialize.readMessageStream(stream, { traversalLimitInWords: 1 }, function() {}, function(e) { errors.push(e); });
+  stream.emit('data', new Uint8Array(serialized));
+  assertNotNull(stream.destroyed);
+  assertEquals(1, errors.length);
+  assertTrue(errors[0] === stream.destroyed);
+};
+
+var messageFile = function() {
+
+  // Messages of varying size and segment count, back to back.
+  var output = new TestOutputStream();
+  for (var i = 0; i < 5; ++i) {
+    var builder = new capnp.test.util.TestMessageBuilder(i * 3 + 1);
+    var root = builder.initRoot(test.TestAllTypes);
+    if (i % 2 === 0) {
+      capnp.test.util.initTestMessage(root);
+    }
+    root.setInt32Field(i);
+    capnp.serialize.writeMessageSegments(output, builder.getSegmentsForOutput());
+  }
+  return output.getData();
+};
+
+var checkMessageFileEntry = function(reader, i) {
+  var root = reader.getRoot(test.TestAllTypes);
+  assertEquals(i, root.getInt32Field());
+  assertEquals(i % 2 === 0 ? 'foo' : '', root.getTextField().toString());
+};
+
+window['test_MessageFileReader'] = function() {
+
+  var data = messageFile();
+  var file = new capnp.serialize.MessageFileReader(data);
+
+  assertEquals(5, file.size());
+  assertEquals(0, file.getIndex()[0]);
+  assertEquals(data.byteLength / 8, file.getIndex()[5]);
+
+  // Random access, without copying.
+  var order = [3, 0, 4, 1, 2, 3];
+  for (var i = 0; i < order.length; ++i) {
+    var reader = file.getMessage(order[i]);
+    assertTrue(reader.getSegment(0).buffer === data);
+    checkMessageFileEntry(reader, order[i]);
+  }
+  assertThrows(function() { file.getMessage(5); });
+
+  var count = 0;
+  for (var reader of file) {
+    checkMessageFileEntry(reader, count++);
+  }
+  assertEquals(5, count);
+
+  // An empty file has no messages.
+  assertEquals(0, new capnp.serialize.MessageFileReader(new ArrayBuffer(0)).size());
+};
+
+window['test_MessageFileIndex'] = function() {
+
+  var data = messageFile();
+  var index = capnp.serialize.writeMessageIndex(capnp.serialize.buildMessageIndex(data));
+
+  var file = new capnp.serialize.MessageFileReader(new Uint8Array(data), null, index);
+  assertEquals(5, file.size());
+  checkMessageFileEntry(file.getMessage(4), 4);
+
+  // An index for a different file is rejected.
+  assertThrows(function() {
+    new capnp.serialize.MessageFileReader(data.slice(0, data.byteLength - 8), null, index);
+  });
+
+  // Also when it is passed in directly rather than loaded.
+  var direct = capnp.serialize.buildMessageIndex(data);
+  assertEquals(5, new capnp.serialize.MessageFileReader(data, null, direct).size());
+  assertThrows(function() {
+    new capnp.serialize.MessageFileReader(data.slice(0, data.byteLength - 8), null, direct);
+  });
+  assertThrows(function() {
+    new capnp.serialize.MessageFileReader(data, null, direct.subarray(1));
+  });
+
+  // So is an index whose boundaries don't match the segment tables.
+  var wrong = new Uint32Array(index.slice(0));
+  wrong[2] += 1;
+  file = new capnp.serialize.MessageFileReader(data, null, wrong.buffer);
+  checkMessageFileEntry(file.getMessage(0), 0);
+  assertThrows(function() { file.getMessage(1); });
+};
+
+window['test_MessageFileTruncated'] = function() {
+
+  var data = messageFile();
+  assertThrows(function() { capnp.serialize.buildMessageIndex(data.slice(0, data.byteLength - 8)); });
+  assertThrows(function() { capnp.serialize.buildMessageIndex(data, { traversalLimitInWords: 2 }); });
+};
+
+window['test_MessageFrameIterator'] = function() {
+
+  var data = messageFile();
+  var frames = new capnp.serialize.MessageFrameIterator(data);
+
+  checkMessageFileEntry(frames.next().value, 0);
+  checkMessageFileEntry(frames.next().value, 1);
+
+  // Resume from the saved position.
+  var count = 2;
+  for (var reader of new capnp.serialize.MessageFrameIterator(data, null, frames.wordOffset)) {
+    checkMessageFileEntry(reader, count++);
+  }
+  assertEquals(5, count);
+
+  frames = new capnp.serialize.MessageFrameIterator(data.slice(0, data.byteLength - 8));
+  for (var i = 0; i < 4; ++i) {
+    frames.next();
+  }
+  assertThrows(function() { frames.next(); });
+};
+
 var isNode = 
   typeof global !== "undefined" && 
   {}.toString.call(global) == '[object global]';